@@ -5,6 +5,47 @@
  * 
  */
 #include "AbstractKernelBasedImageFilterTransform.h"
+#include "../Utilities/ImageBufferPool.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+/**
+ * @brief Grayscale check of the image version convolved last.
+ */
+struct GrayscaleCheck {
+    qint64 key = 0;             //!< QImage::cacheKey() of the version.
+    QSize size;                 //!< Size of the version.
+    bool grayscale = false;     //!< Result of PixelHelper::isGrayscale() for the version.
+};
+
+GrayscaleCheck lastCheck;       //!< Filters are usually applied to the same image again, e.g. while a size is tried out.
+QMutex lastCheckMutex;          //!< Guards lastCheck.
+
+/**
+ * @brief Checks whether img is grayscale, scanning it only if the check of this version is not cached.
+ *
+ * @param img Image in PixelHelper::WORKING_FORMAT.
+ * @return true Image content is grayscale.
+ * @return false At least one pixel has color.
+ */
+bool isGrayscale(const QImage& img)
+{
+    {
+        QMutexLocker locker(&lastCheckMutex);
+        if (lastCheck.key == img.cacheKey() && lastCheck.size == img.size()) {
+            return lastCheck.grayscale;
+        }
+    }
+    const bool grayscale = PixelHelper::isGrayscale(img);
+    QMutexLocker locker(&lastCheckMutex);
+    lastCheck.key = img.cacheKey();
+    lastCheck.size = img.size();
+    lastCheck.grayscale = grayscale;
+    return grayscale;
+}
+}
 
 /**
  * @brief Construct a new Abstract Kernel Based Image Filter Transform:: Abstract Kernel Based Image Filter Transform object.
@@ -45,7 +86,7 @@ QImage AbstractKernelBasedImageFilterTransform::applyFilter(const QImage &img, i
  */
 QImage AbstractKernelBasedImageFilterTransform::convolution(const QImage &img) const
 {
-    QImage newImage{img}; // create new image
+    QImage newImage = ImageBufferPool::acquireLike(img); // every pixel is written below, so no copy of img is needed
     int normalizeFactor = 0;                    //normalize the kernel
     for(int dx = -size +1 ; dx<size; ++dx){
         for(int dy = -size + 1; dy<size; ++dy){
@@ -53,6 +94,12 @@ QImage AbstractKernelBasedImageFilterTransform::convolution(const QImage &img) c
         }
     }
 
+    // Grayscale content only needs one channel convolved, read from one byte per pixel instead of four.
+    if (isGrayscale(img)) {
+        convolutionGrayscale(PixelHelper::toGrayscale8(img), newImage, normalizeFactor);
+        return newImage;
+    }
+
     for (int i = 0; i < img.width(); ++i) {
         for (int j = 0; j < img.height(); ++j) {
             QRgb color = qRgb(0, 0, 0);//initialize to black
@@ -84,6 +131,35 @@ QImage AbstractKernelBasedImageFilterTransform::convolution(const QImage &img) c
     return newImage;
 }
 
+/**
+ * @brief Convolve a one byte per pixel grayscale image with kernel.
+ * @details Gives the same result as convolving the equivalent 32-bit gray image channel by channel.
+ *
+ * @param gray Format_Grayscale8 image to convolve.
+ * @param newImage Output image in PixelHelper::WORKING_FORMAT, with the size of gray.
+ * @param normalizeFactor Sum of the kernel entries.
+ */
+void AbstractKernelBasedImageFilterTransform::convolutionGrayscale(const QImage &gray, QImage &newImage, int normalizeFactor) const
+{
+    for (int j = 0; j < gray.height(); ++j) {
+        QRgb* line = reinterpret_cast<QRgb*>(newImage.scanLine(j));
+        for (int i = 0; i < gray.width(); ++i) {
+            int total = 0;
+            for(int dx = -size + 1; dx < size; ++dx) {
+                for(int dy = -size + 1; dy < size; ++dy) {
+                    int X = i + dx, Y = j + dy;
+                    if((0 <= X && X < gray.width()) && (0 <= Y && Y < gray.height())) {
+                        total += getEntry(dx, dy) * gray.constScanLine(Y)[X];
+                    }
+                }
+            }
+            total /= normalizeFactor;
+            total = qBound(0, total, 255);
+            line[i] = qRgb(total, total, total);
+        }
+    }
+}
+
 /**
  * @brief Gets kernel entry at position x, y.
  * @details 0, 0 is the center of the matrix.
@@ -23,6 +23,7 @@ protected:
     void setEntry(int x, int y, double value);
     void setSize(int newSize);
     void redefineKernel(int size);
+    void convolutionGrayscale(const QImage& gray, QImage& newImage, int normalizeFactor) const;
 
 private:
     int size;                           //!< Size/radius of the kernel. E.g. size 3 means 3*2-1 = 5. A 5x5 matrix.
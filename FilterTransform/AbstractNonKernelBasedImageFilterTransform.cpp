@@ -5,6 +5,8 @@
  * 
  */
 #include "AbstractNonKernelBasedImageFilterTransform.h"
+#include "../Utilities/ImageBufferPool.h"
+#include "../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Abstract Non Kernel Based Image Filter Transform:: Abstract Non Kernel Based Image Filter Transform object
@@ -28,3 +30,97 @@ QImage AbstractNonKernelBasedImageFilterTransform::applyFilter(const QImage &img
 {
     return applyFilter(img, strength);
 }
+
+/**
+ * @brief Whether the filter is a point operation.
+ * @details A point operation computes every output pixel from the input pixel at the same position only,
+ * through applyToPixel(). Consecutive point operations can be fused into one pass, see OperationGraph.
+ *
+ * @return true The filter implements applyToPixel().
+ * @return false The filter needs the whole image, e.g. rotations.
+ */
+bool AbstractNonKernelBasedImageFilterTransform::isPointOperation() const
+{
+    return false;
+}
+
+/**
+ * @brief Whether the point operation maps red, green and blue independently of each other.
+ * @details Then the operation is fully described by three 256 entry look-up tables,
+ * e.g. a histogram can be updated by remapping its bins instead of rescanning the image.
+ *
+ * @return true Every output channel only depends on the same input channel.
+ * @return false The channels are mixed, e.g. through HSV, or the filter is no point operation.
+ */
+bool AbstractNonKernelBasedImageFilterTransform::isChannelSeparable() const
+{
+    return false;
+}
+
+/**
+ * @brief Applies the filter to a single pixel. Only meaningful if isPointOperation() is true.
+ *
+ * @param pixel Input pixel.
+ * @param strength Strength of the filter/transform.
+ * @return QRgb Output pixel. The default implementation returns pixel unchanged.
+ */
+QRgb AbstractNonKernelBasedImageFilterTransform::applyToPixel(QRgb pixel, double) const
+{
+    return pixel;
+}
+
+/**
+ * @brief Applies the filter to high precision pixels, see FloatImage. Only meaningful if isPointOperation() is true.
+ * @details The default implementation quantises each pixel to 8 bits, calls applyToPixel() and converts back,
+ * so it is exact but gains no precision. Filters override it to work on the float values directly.
+ *
+ * @param rgba Interleaved RGBA pixels, FloatImage::CHANNELS floats each.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void AbstractNonKernelBasedImageFilterTransform::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    for (int i = 0; i < count; ++i) {
+        float* pixel = rgba + i * FloatImage::CHANNELS;
+        QRgb result = applyToPixel(FloatImage::toRgb(pixel), strength);
+        FloatImage::fromRgb(result, pixel);
+    }
+}
+
+/**
+ * @brief Applies applyToPixel() to every pixel of img.
+ * @details The output is allocated without copying img, since every pixel is overwritten.
+ *
+ * @param img Original image, basis of filter/transformation.
+ * @param strength Strength of the filter/transform.
+ * @return QImage Filtered/transformed image.
+ */
+QImage AbstractNonKernelBasedImageFilterTransform::applyPointOperation(const QImage &img, double strength) const
+{
+    QImage newImage = ImageBufferPool::acquireLike(img);
+    for (int j = 0; j < img.height(); ++j) {
+        const QRgb* source = reinterpret_cast<const QRgb*>(img.constScanLine(j));
+        QRgb* line = reinterpret_cast<QRgb*>(newImage.scanLine(j));
+        for (int i = 0; i < img.width(); ++i) {
+            line[i] = applyToPixel(source[i], strength);
+        }
+    }
+    return newImage;
+}
+
+/**
+ * @brief Applies applyToPixel() to every pixel of img, in place.
+ * @details Nothing is copied if the caller holds the only reference to img.
+ *
+ * @param img Image to filter/transform.
+ * @param strength Strength of the filter/transform.
+ */
+void AbstractNonKernelBasedImageFilterTransform::applyPointOperationInPlace(QImage &img, double strength) const
+{
+    for (int j = 0; j < img.height(); ++j) {
+        QRgb* line = reinterpret_cast<QRgb*>(img.scanLine(j));
+        for (int i = 0; i < img.width(); ++i) {
+            line[i] = applyToPixel(line[i], strength);
+        }
+    }
+}
@@ -11,6 +11,15 @@ public:
     virtual QImage applyFilter(const QImage &img, int size, double strength) override;
     virtual QImage applyFilter(const QImage &img, double strength) const = 0;
     virtual QImage applyFilter(const QImage &img) const = 0;
+
+    virtual bool isPointOperation() const;
+    virtual bool isChannelSeparable() const;
+    virtual QRgb applyToPixel(QRgb pixel, double strength) const;
+    virtual void applyToFloatPixels(float *rgba, int count, double strength) const;
+    void applyPointOperationInPlace(QImage &img, double strength) const;
+
+protected:
+    QImage applyPointOperation(const QImage &img, double strength) const;
 };
 
 #endif // ABSTRACTNONKERNELBASEDIMAGEFILTERTRANSFORM_H
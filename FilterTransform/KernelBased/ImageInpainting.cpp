@@ -3,6 +3,9 @@
  * @brief Image Inpainting Filter kernel implementation.
  */
 #include "ImageInpainting.h"
+#include "../../Utilities/ImageStatistics.h"
+
+#include <QtConcurrent>
 
 /**
  * @brief Construct a new Image Inpainting:: Image Inpainting object
@@ -73,114 +76,322 @@ void ImageInpainting::setKernel(int size, double)
 }
 
 /**
- * @brief Overriden inpainting convolution algorithm.
+ * @brief Overriden inpainting convolution algorithm, a coarse-to-fine (multigrid) solver.
+ * @details The image and the hole are halved until the hole is at most COARSEST_HOLE_SIZE pixels wide (or MAX_LEVELS is reached).
+ * A coarse pixel is part of the hole only if all four pixels below it are, otherwise it averages the known ones.
+ * The hole is filled at the coarsest level first, starting from the average color and relaxing until it converges.
+ * Every finer level then starts from the bilinearly upsampled coarser result and only needs MAX_ITERATIONS_PER_LEVEL passes to refine it.
+ * Diffusion only travels one kernel radius per pass, so doing the long-range work at the coarse levels
+ * keeps the number of passes small regardless of the size of the hole.
+ * The number of passes run over all levels is available through getIterationCount().
  * 
  * @param img Image to convolve.
  * @return QImage Convolved image.
  */
 QImage ImageInpainting::convolution(const QImage &img) const
 {
-    QImage newImage{img};    // create new image
-    int normalizeFactor = 0; //normalize the kernel
-    const int MAXNUMREPEAT = 80;
+    Q_ASSERT(img.depth() == 32);
     int widthThreshold = img.width() > mask.width() ? mask.width() : img.width();
     int heightThreshold = img.height() > mask.height() ? mask.height() : img.height();
-    for (int dx = -size + 1; dx < size; ++dx)
+    iterationCount = 0;
+
+    //decode the mask once, clipped to the image
+    QVector<Level> pyramid(1);
+    pyramid[0].image = img;
+    if (mask.size() == img.size())
     {
-        for (int dy = -size + 1; dy < size; ++dy)
+        pyramid[0].mask = mask;
+    }
+    else
+    {
+        pyramid[0].mask = BitMask(img.width(), img.height());
+        Level& full = pyramid[0];
+        mask.forEachSetBit([&full](int x, int y) { full.mask.setBit(x, y); });
+    }
+    decodeLevel(pyramid[0]);
+    if (pyramid[0].activePixels.isEmpty())
+    {
+        return img;
+    }
+
+    //build the pyramid until the hole is small compared to the kernel
+    while (pyramid.size() < MAX_LEVELS && !pyramid.last().activePixels.isEmpty())
+    {
+        const Level& fine = pyramid.last();
+        if (qMax(fine.boundingBox.width(), fine.boundingBox.height()) <= COARSEST_HOLE_SIZE
+                || qMin(fine.image.width(), fine.image.height()) < 2 * COARSEST_HOLE_SIZE)
         {
-            normalizeFactor += getEntry(dx, dy);
+            break;
         }
+        pyramid.append(downsample(fine));
     }
 
-    //fill in missing region with input's average color
-    long long avgRed = 0, avgGreen = 0, avgBlue = 0;
-    for(int i = 0; i<widthThreshold; ++i){
-        for(int j = 0; j<heightThreshold; ++j){
-            QRgb pixel = PixelHelper::getPixel(img, i, j);
-            avgRed += qRed(pixel);
-            avgGreen += qGreen(pixel);
-            avgBlue += qBlue(pixel);
+    //fill in missing region of the coarsest level with input's average color
+    QRgb average;
+    if (widthThreshold == img.width() && heightThreshold == img.height())
+    {
+        //whole image, cached per image version
+        const ImageStatistics statistics = ImageStatistics::of(img);
+        average = qRgb(static_cast<int>(statistics.mean(ImageHistogram::RED)),
+                       static_cast<int>(statistics.mean(ImageHistogram::GREEN)),
+                       static_cast<int>(statistics.mean(ImageHistogram::BLUE)));
+    }
+    else
+    {
+        long long avgRed = 0, avgGreen = 0, avgBlue = 0;
+        for (int j = 0; j < heightThreshold; ++j)
+        {
+            const QRgb* line = reinterpret_cast<const QRgb*>(img.constScanLine(j));
+            for (int i = 0; i < widthThreshold; ++i)
+            {
+                avgRed += qRed(line[i]);
+                avgGreen += qGreen(line[i]);
+                avgBlue += qBlue(line[i]);
             }
         }
-    avgRed /= widthThreshold * heightThreshold;
-    avgGreen /= widthThreshold * heightThreshold;
-    avgBlue /= widthThreshold * heightThreshold;
-
-    //actual formula: (1 - mask/255) * image + (mask/255) * average
-    for(int i = 0; i<widthThreshold; ++i){
-        for(int j = 0; j<heightThreshold; ++j){
-                QRgb maskPixel = PixelHelper::getPixel(mask, i, j);
-                //remove the white part in mask
-                if(maskPixel != qRgb(0,0,0)){
-                    int thisRed =  (qRed(maskPixel)/255.0) * avgRed;
-                    int thisGreen = (qGreen(maskPixel)/255.0) * avgGreen;
-                    int thisBlue =  (qBlue(maskPixel)/255.0) * avgBlue;
-                    thisRed = qBound(0, thisRed, 255);
-                    thisGreen = qBound(0, thisGreen, 255);
-                    thisBlue = qBound(0, thisBlue, 255);
-                    PixelHelper::setPixel(newImage, i, j, qRgb(thisRed, thisGreen, thisBlue));
+        avgRed /= widthThreshold * heightThreshold;
+        avgGreen /= widthThreshold * heightThreshold;
+        avgBlue /= widthThreshold * heightThreshold;
+        average = qRgb(qBound(0, static_cast<int>(avgRed), 255), qBound(0, static_cast<int>(avgGreen), 255), qBound(0, static_cast<int>(avgBlue), 255));
+    }
+
+    Level& coarsest = pyramid.last();
+    for (const QPoint& point : coarsest.activePixels)
+    {
+        PixelHelper::setPixel(coarsest.image, point.x(), point.y(), average);
+    }
+    iterationCount += relax(coarsest, MAX_ITERATIONS);
+
+    //refine level by level, starting each from the upsampled coarser result
+    for (int level = pyramid.size() - 2; level >= 0; --level)
+    {
+        upsample(pyramid[level + 1].image, pyramid[level]);
+        iterationCount += relax(pyramid[level], MAX_ITERATIONS_PER_LEVEL);
+    }
+    return pyramid[0].image;
+}
+
+/**
+ * @brief Decodes the mask of a level into its worklist, in row-major order for cache locality, and bounding box.
+ *
+ * @param level Level whose mask is decoded.
+ */
+void ImageInpainting::decodeLevel(Level& level)
+{
+    level.activePixels.clear();
+    level.activePixels.reserve(level.mask.count());
+    level.mask.forEachSetBit([&level](int x, int y) { level.activePixels.append(QPoint(x, y)); });
+    level.boundingBox = level.mask.boundingBox();
+}
+
+/**
+ * @brief Builds the next coarser level, half the width and height.
+ * @details A coarse pixel is in the hole only if every fine pixel below it is, otherwise it is the average of the known fine pixels.
+ *
+ * @param fine Level to downsample.
+ * @return ImageInpainting::Level Coarser level, decoded.
+ */
+ImageInpainting::Level ImageInpainting::downsample(const Level& fine)
+{
+    Level coarse;
+    const int width = (fine.image.width() + 1) / 2, height = (fine.image.height() + 1) / 2;
+    coarse.image = QImage(width, height, PixelHelper::WORKING_FORMAT);
+    coarse.mask = BitMask(width, height);
+    for (int j = 0; j < height; ++j)
+    {
+        QRgb* imageLine = reinterpret_cast<QRgb*>(coarse.image.scanLine(j));
+        for (int i = 0; i < width; ++i)
+        {
+            int red = 0, green = 0, blue = 0, alpha = 0, known = 0;
+            for (int y = 2 * j; y < qMin(2 * j + 2, fine.image.height()); ++y)
+            {
+                for (int x = 2 * i; x < qMin(2 * i + 2, fine.image.width()); ++x)
+                {
+                    if (!fine.mask.testBit(x, y))
+                    {
+                        QRgb pixel = PixelHelper::getPixel(fine.image, x, y);
+                        red += qRed(pixel);
+                        green += qGreen(pixel);
+                        blue += qBlue(pixel);
+                        alpha += qAlpha(pixel);
+                        ++known;
+                    }
                 }
             }
+            coarse.mask.setBit(i, j, known == 0);
+            imageLine[i] = known == 0 ? qRgb(0, 0, 0) : qRgba(red / known, green / known, blue / known, alpha / known);
         }
+    }
+    decodeLevel(coarse);
+    return coarse;
+}
+
+/**
+ * @brief Initialises the hole of a level from the coarser result, with bilinear interpolation.
+ *
+ * @param coarse Image of the next coarser level, already filled.
+ * @param fine Level whose hole is initialised.
+ */
+void ImageInpainting::upsample(const QImage& coarse, Level& fine)
+{
+    for (const QPoint& point : fine.activePixels)
+    {
+        const double x = qBound(0.0, (point.x() + 0.5) / 2 - 0.5, coarse.width() - 1.0);
+        const double y = qBound(0.0, (point.y() + 0.5) / 2 - 0.5, coarse.height() - 1.0);
+        const int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+        const int x1 = qMin(x0 + 1, coarse.width() - 1), y1 = qMin(y0 + 1, coarse.height() - 1);
+        const double fx = x - x0, fy = y - y0;
+        const QRgb p00 = PixelHelper::getPixel(coarse, x0, y0), p10 = PixelHelper::getPixel(coarse, x1, y0);
+        const QRgb p01 = PixelHelper::getPixel(coarse, x0, y1), p11 = PixelHelper::getPixel(coarse, x1, y1);
+        auto interpolate = [fx, fy](int c00, int c10, int c01, int c11) {
+            return qBound(0, qRound((c00 * (1 - fx) + c10 * fx) * (1 - fy) + (c01 * (1 - fx) + c11 * fx) * fy), 255);
+        };
+        PixelHelper::setPixel(fine.image, point.x(), point.y(),
+                              qRgb(interpolate(qRed(p00), qRed(p10), qRed(p01), qRed(p11)),
+                                   interpolate(qGreen(p00), qGreen(p10), qGreen(p01), qGreen(p11)),
+                                   interpolate(qBlue(p00), qBlue(p10), qBlue(p01), qBlue(p11))));
+    }
+}
+
+/**
+ * @brief Repeats the inpainting convolution on the hole of a level until it converges.
+ * @details Only the pixels in the worklist and their kernel neighbourhoods are visited.
+ * The pixels are split into colour classes by (x mod (radius + 1), y mod (radius + 1)), a generalisation of red-black ordering:
+ * no pixel of a class lies in the kernel neighbourhood of another pixel of the same class.
+ * Each sweep updates the classes one after another, and all pixels of one class are independent,
+ * so they are updated in parallel, in place, and the result does not depend on the number of threads or their scheduling.
+ * Neighbourhood bounds checks are skipped if the bounding box is far enough from the image border.
+ * Iterations stop as soon as the largest per-channel change of a pass is at most CONVERGENCE_TOLERANCE, or after maxIterations passes.
+ *
+ * @param level Level to relax, its image is modified in place.
+ * @param maxIterations Upper bound on the number of passes.
+ * @return int Number of passes run.
+ */
+int ImageInpainting::relax(Level& level, int maxIterations) const
+{
+    QImage& image = level.image;
+    int normalizeFactor = 0; //normalize the kernel
 
-    //implement repetition for convolution with kernel
-    for(int k = 0; k<MAXNUMREPEAT; ++k){
-        for (int i = 0; i < widthThreshold; ++i)
+    //kernel entries as flat offset/weight lists, the middle entry is 0 and skipped
+    QVector<QPoint> offsets;
+    QVector<double> weights;
+    for (int dx = -size + 1; dx < size; ++dx)
+    {
+        for (int dy = -size + 1; dy < size; ++dy)
         {
-            for (int j = 0; j <heightThreshold; ++j)
+            normalizeFactor += getEntry(dx, dy);
+            if (getEntry(dx, dy) != 0)
             {
-                if (PixelHelper::getPixel(mask, i, j) != qRgb(0, 0, 0)) //assume mask has same size as img and monochrome.
-                {                                                       //perform operation only for non-black parts of mask
-                    QRgb color = qRgb(0, 0, 0); //initialize to black
-                    int rTotal = 0, gTotal = 0, bTotal = 0;
-                    for (int dx = -size + 1; dx < size; ++dx)
-                    {
-                        for (int dy = -size + 1; dy < size; ++dy)
-                        {
-                            int X = i + dx, Y = j + dy;
-                            if ((0 < X && X < img.width()) && (0 < Y && Y < img.height()))
-                            {
-                                QRgb pixel = PixelHelper::getPixel(newImage, X, Y);
-                                if(pixel != qRgb(255,255,255)){
-                                rTotal += getEntry(dx, dy) * qRed(pixel);
-                                gTotal += getEntry(dx, dy) * qGreen(pixel);
-                                bTotal += getEntry(dx, dy) * qBlue(pixel);
-                                }
-                            }
-                        }
-                    }
-                    rTotal /= normalizeFactor;
-                    gTotal /= normalizeFactor;
-                    bTotal /= normalizeFactor;
+                offsets.append(QPoint(dx, dy));
+                weights.append(getEntry(dx, dy));
+            }
+        }
+    }
+
+    uchar* bits = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+    auto pixelAt = [bits, bytesPerLine](int x, int y) -> QRgb& {
+        return reinterpret_cast<QRgb*>(bits + y * bytesPerLine)[x];
+    };
 
-                    rTotal = qBound(0, rTotal, 255);
-                    gTotal = qBound(0, gTotal, 255);
-                    bTotal = qBound(0, bTotal, 255);
-                    color = qRgb(rTotal, gTotal, bTotal);
+    //neighbours must satisfy 0 < X < width and 0 < Y < height, skip the test if the whole neighbourhood does
+    const int radius = size - 1;
+    const bool checkBounds = !QRect(1, 1, image.width() - 1, image.height() - 1).contains(level.boundingBox.adjusted(-radius, -radius, radius, radius));
+
+    //split the worklist into independent colour classes, each keeps row-major order
+    const int period = radius + 1;
+    QVector<QVector<QPoint>> classes(period * period);
+    for (const QPoint& point : level.activePixels)
+    {
+        classes[(point.y() % period) * period + point.x() % period].append(point);
+    }
 
-                    PixelHelper::setPixel(newImage, i, j, color);
+    //updates pixels [begin, end) of a class, returns the largest per-channel change
+    auto relaxRange = [&](const QVector<QPoint>& pixels, int begin, int end) {
+        int maxChange = 0;
+        for (int p = begin; p < end; ++p)
+        {
+            const QPoint& point = pixels[p];
+            int rTotal = 0, gTotal = 0, bTotal = 0;
+            for (int n = 0; n < offsets.size(); ++n)
+            {
+                int X = point.x() + offsets[n].x(), Y = point.y() + offsets[n].y();
+                if (checkBounds && !((0 < X && X < image.width()) && (0 < Y && Y < image.height())))
+                {
+                    continue;
+                }
+                QRgb pixel = pixelAt(X, Y);
+                if (pixel != qRgb(255, 255, 255))
+                {
+                    rTotal += weights[n] * qRed(pixel);
+                    gTotal += weights[n] * qGreen(pixel);
+                    bTotal += weights[n] * qBlue(pixel);
                 }
             }
+            rTotal /= normalizeFactor;
+            gTotal /= normalizeFactor;
+            bTotal /= normalizeFactor;
+
+            rTotal = qBound(0, rTotal, 255);
+            gTotal = qBound(0, gTotal, 255);
+            bTotal = qBound(0, bTotal, 255);
+
+            QRgb& target = pixelAt(point.x(), point.y());
+            maxChange = qMax(maxChange, qAbs(qRed(target) - rTotal));
+            maxChange = qMax(maxChange, qAbs(qGreen(target) - gTotal));
+            maxChange = qMax(maxChange, qAbs(qBlue(target) - bTotal));
+            target = qRgb(rTotal, gTotal, bTotal);
+        }
+        return maxChange;
+    };
+
+    //implement repetition for convolution with kernel, only on the masked pixels, until the fill settles
+    int iterations = 0;
+    int maxChange = CONVERGENCE_TOLERANCE + 1;
+    while (iterations < maxIterations && maxChange > CONVERGENCE_TOLERANCE)
+    {
+        maxChange = 0;
+        for (const QVector<QPoint>& pixels : classes)
+        {
+            if (pixels.size() < PARALLEL_CHUNK_SIZE)
+            {
+                maxChange = qMax(maxChange, relaxRange(pixels, 0, pixels.size()));
+                continue;
+            }
+            QVector<int> chunks((pixels.size() + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
+            for (int c = 0; c < chunks.size(); ++c)
+            {
+                chunks[c] = c;
+            }
+            QVector<int> changes(chunks.size());
+            QtConcurrent::blockingMap(chunks, [&](int c) {
+                changes[c] = relaxRange(pixels, c * PARALLEL_CHUNK_SIZE, qMin((c + 1) * PARALLEL_CHUNK_SIZE, pixels.size()));
+            });
+            for (int change : changes)
+            {
+                maxChange = qMax(maxChange, change);
+            }
         }
+        ++iterations;
     }
-    return newImage;
+    return iterations;
 }
 
 /**
  * @brief Returns image mask.
+ * @details Filled pixels are white, the rest black.
  * 
  * @return QImage 
  */
 QImage ImageInpainting::getMask() {
-    return mask;
+    return mask.toImage(qRgb(255, 255, 255), qRgb(0, 0, 0));
 }
 
 /**
  * @brief Sets image mask.
  * 
- * @param mask New image to set as inpainting mask.
+ * @param mask New image to set as inpainting mask, non-black pixels are filled.
  */
 void ImageInpainting::setMask(const QImage &mask) {
-    this->mask = mask;
+    this->mask = BitMask::fromImage(mask, qRgb(0, 0, 0));
 }
@@ -2,6 +2,7 @@
 #define IMAGEINPAINTING_H
 
 #include "../AbstractKernelBasedImageFilterTransform.h"
+#include "../../Utilities/BitMask.h"
 
 class ImageInpainting : public AbstractKernelBasedImageFilterTransform
 {
@@ -19,10 +20,36 @@ public:
 
     virtual QImage getMask();
     virtual void setMask(const QImage& mask);
+    int getIterationCount() const { return iterationCount; }   //!< Iterations run by the last convolution().
+
+public:
+    static const int MAX_ITERATIONS = 80;           //!< Upper bound on the number of iterations on the coarsest level.
+    static const int MAX_ITERATIONS_PER_LEVEL = 8;  //!< Upper bound on the number of refinement iterations on every finer level.
+    static const int CONVERGENCE_TOLERANCE = 1;     //!< Iterations stop once no channel of any filled pixel changes by more than this.
+    static const int COARSEST_HOLE_SIZE = 16;       //!< The pyramid stops once the hole's bounding box fits in this many pixels.
+    static const int MAX_LEVELS = 8;                //!< Upper bound on the number of pyramid levels, including full resolution.
+    static const int PARALLEL_CHUNK_SIZE = 4096;    //!< Pixels of one colour class updated by one task.
+
+private:
+    /**
+     * @brief One resolution of the inpainting pyramid.
+     */
+    struct Level {
+        QImage          image;          //!< Image at this resolution, the hole is filled in place.
+        BitMask         mask;           //!< Mask at this resolution, set pixels are filled.
+        QVector<QPoint> activePixels;   //!< Pixels to fill, in row-major order.
+        QRect           boundingBox;    //!< Bounding box of activePixels.
+    };
+
+    static void decodeLevel(Level& level);
+    static Level downsample(const Level& fine);
+    static void upsample(const QImage& coarse, Level& fine);
+    int relax(Level& level, int maxIterations) const;
 
 private:
-    QImage mask;    //!< Inpainting mask.
-    int size;       //!< Kernel size.
+    BitMask mask;                   //!< Inpainting mask, set pixels are filled.
+    int size;                       //!< Kernel size.
+    mutable int iterationCount = 0; //!< Iterations run by the last convolution().
 };
 
 #endif // IMAGEINPAINTING_H
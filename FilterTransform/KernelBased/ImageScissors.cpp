@@ -64,6 +64,7 @@ void ImageScissors::setKernel(int, double)
 
 /**
  * @brief Overriden inpainting convolution algorithm.
+ * @details Only the set pixels of the mask are visited, pixels outside the mask are kept.
  * 
  * @param img Image to convolve.
  * @return QImage Convolved image.
@@ -72,15 +73,11 @@ QImage ImageScissors::convolution(const QImage &img) const
 {
     QImage newImage{img};    // create new image
 
-    for (int i = 0; i < img.width(); ++i)
-    {
-        for (int j = 0; j < img.height(); ++j)
-        {
-          if(PixelHelper::getPixel(mask, i, j) != qRgb(255,255,255)){   //no kernel used, since identity.
-                PixelHelper::setPixel(newImage, i, j, Qt::white);
-            }
+    mask.forEachSetBit([&newImage](int i, int j) {
+        if (i < newImage.width() && j < newImage.height()) {    //no kernel used, since identity.
+            PixelHelper::setPixel(newImage, i, j, Qt::white);
         }
-    }
+    });
     return newImage;
 }
 
@@ -90,14 +87,14 @@ QImage ImageScissors::convolution(const QImage &img) const
  * @return QImage 
  */
 QImage ImageScissors::getMask() {
-    return mask;
+    return mask.toImage(qRgb(0, 0, 0), qRgb(255, 255, 255));
 }
 
 /**
  * @brief Sets image mask.
  * 
- * @param mask New image to set as image scissors mask.
+ * @param mask New image to set as image scissors mask, non-white pixels are cut.
  */
 void ImageScissors::setMask(const QImage &mask) {
-    this->mask = mask;
+    this->mask = BitMask::fromImage(mask, qRgb(255, 255, 255));
 }
@@ -2,6 +2,7 @@
 #define IMAGESCISSORS_H
 
 #include "../AbstractKernelBasedImageFilterTransform.h"
+#include "../../Utilities/BitMask.h"
 
 class ImageScissors : public AbstractKernelBasedImageFilterTransform
 {
@@ -21,7 +22,7 @@ public:
     virtual void setMask(const QImage& mask);
 
 private:
-    QImage mask;    //!< Scissor mask.
+    BitMask mask;   //!< Scissor mask, set pixels are cut.
     int size;       //!< Kernel size.
 };
 
@@ -0,0 +1,119 @@
+/**
+ * @class AutoLevelsFilter
+ * @brief Auto Levels and Auto Contrast Non-Kernel Implementation.
+ * @details Black and white points are picked from histogram percentiles and stretched to 0 and 255 through one look-up table per channel.
+ * The histogram comes from ImageStatistics, so an image already counted for the Histogram palette is not scanned again,
+ * and the look-up tables are applied in one parallel pass.
+ * Since the tables depend on the whole image, this is not a point operation in the sense of OperationGraph.
+ */
+#include "AutoLevelsFilter.h"
+#include "../../Utilities/ImageStatistics.h"
+#include "../../Utilities/ImageBufferPool.h"
+#include "../../Utilities/PixelHelper.h"
+#include <QThread>
+#include <QtConcurrent>
+
+/**
+ * @brief Construct a new Auto Levels Filter:: Auto Levels Filter object
+ *
+ * @param mode Per channel levels or common contrast stretch.
+ * @param parent Passed to AbstractNonKernelBasedImageFilterTransform() constructor.
+ */
+AutoLevelsFilter::AutoLevelsFilter(Mode mode, QObject* parent) : AbstractNonKernelBasedImageFilterTransform(parent), mode(mode)
+{
+
+}
+
+/**
+ * @brief Returns the name of the filter.
+ *
+ * @return QString Name of the filter.
+ */
+QString AutoLevelsFilter::getName() const
+{
+    return mode == LEVELS ? "Auto Levels" : "Auto Contrast";
+}
+
+/**
+ * @brief Gets new image after filter applied.
+ *
+ * @param image Original image to get new filter applied image.
+ * @param strength Percentage of pixels clipped at each end of every channel, 0 stretches from minimum to maximum.
+ * @return QImage Filter applied image.
+ */
+QImage AutoLevelsFilter::applyFilter(const QImage &image, double strength) const
+{
+    const ImageStatistics statistics = ImageStatistics::of(image);
+    if (statistics.isNull()) {
+        return QImage{image};
+    }
+    const double clip = qBound(0.0, strength, 49.0) / 100;
+
+    const ImageHistogram::Channel channels[3] = {ImageHistogram::RED, ImageHistogram::GREEN, ImageHistogram::BLUE};
+    int black[3], white[3];
+    for (int c = 0; c < 3; ++c) {
+        black[c] = statistics.percentile(channels[c], clip);
+        white[c] = statistics.percentile(channels[c], 1 - clip);
+    }
+    if (mode == CONTRAST) {
+        // The darkest black point and the brightest white point, so no channel is clipped more than requested
+        const int commonBlack = qMin(black[0], qMin(black[1], black[2]));
+        const int commonWhite = qMax(white[0], qMax(white[1], white[2]));
+        for (int c = 0; c < 3; ++c) {
+            black[c] = commonBlack;
+            white[c] = commonWhite;
+        }
+    }
+
+    uchar table[3][ImageHistogram::BINS];
+    bool identity = true;
+    for (int c = 0; c < 3; ++c) {
+        for (int value = 0; value < ImageHistogram::BINS; ++value) {
+            // A flat channel has nothing to stretch
+            int mapped = value;
+            if (white[c] > black[c]) {
+                mapped = qBound(0, ((value - black[c]) * 255 + (white[c] - black[c]) / 2) / (white[c] - black[c]), 255);
+            }
+            table[c][value] = static_cast<uchar>(mapped);
+            identity = identity && mapped == value;
+        }
+    }
+    if (identity) {
+        return QImage{image};
+    }
+
+    // Bands of rows in parallel, every band reads and writes its own rows only
+    const QImage source = PixelHelper::toWorkingFormat(image);
+    QImage newImage = ImageBufferPool::acquireLike(source);
+    uchar* bits = newImage.bits();
+    const int bytesPerLine = newImage.bytesPerLine();
+    const int height = source.height(), width = source.width();
+    const int bandCount = qMin(height, qMax(1, QThread::idealThreadCount() * 4));
+    const int rowsPerBand = (height + bandCount - 1) / bandCount;
+    QVector<int> bands;
+    for (int firstRow = 0; firstRow < height; firstRow += rowsPerBand) {
+        bands.append(firstRow);
+    }
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        for (int j = firstRow; j < qMin(firstRow + rowsPerBand, height); ++j) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(source.constScanLine(j));
+            QRgb* target = reinterpret_cast<QRgb*>(bits + j * bytesPerLine);
+            for (int i = 0; i < width; ++i) {
+                const QRgb rgb = line[i];
+                target[i] = qRgba(table[0][qRed(rgb)], table[1][qGreen(rgb)], table[2][qBlue(rgb)], qAlpha(rgb));
+            }
+        }
+    });
+    return newImage;
+}
+
+/**
+ * @brief Applies the filter with the default clip percentage.
+ *
+ * @param image Original image to get new filter applied image.
+ * @return QImage Filter applied image.
+ */
+QImage AutoLevelsFilter::applyFilter(const QImage &image) const
+{
+    return applyFilter(image, DEFAULT_CLIP_PERCENT);
+}
@@ -0,0 +1,33 @@
+#ifndef AUTOLEVELSFILTER_H
+#define AUTOLEVELSFILTER_H
+
+#include "../AbstractNonKernelBasedImageFilterTransform.h"
+
+class AutoLevelsFilter : public AbstractNonKernelBasedImageFilterTransform
+{
+    Q_OBJECT
+public:
+/**
+ * @enum Mode.
+ *
+ * @brief How black and white points are chosen.
+ */
+    enum Mode {
+        LEVELS,     //!< Every channel is stretched on its own, which also neutralises color casts.
+        CONTRAST    //!< One black and white point for all channels, hues are kept.
+    };
+
+public:
+    explicit AutoLevelsFilter(Mode mode = LEVELS, QObject *parent = nullptr);
+    virtual QString getName() const override;
+    virtual QImage applyFilter(const QImage &img, double strength) const override;
+    virtual QImage applyFilter(const QImage &img) const override;
+
+public:
+    static constexpr double DEFAULT_CLIP_PERCENT = 0.5;     //!< Percentage of pixels clipped to black and to white, so outliers do not dominate.
+
+private:
+    Mode mode;      //!< Levels or contrast.
+};
+
+#endif // AUTOLEVELSFILTER_H
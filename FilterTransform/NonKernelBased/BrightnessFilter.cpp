@@ -3,6 +3,7 @@
  * @brief Brightness Filter Non-Kernel Implementation.
  */
 #include "BrightnessFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Brightness Filter:: Brightness Filter object
@@ -33,26 +34,42 @@ QString BrightnessFilter::getName() const
  */
 QImage BrightnessFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
-
     // This filter will be dealing with integer strength values
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
     }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The brightness filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool BrightnessFilter::isPointOperation() const
+{
+    return true;
+}
 
+/**
+ * @brief Applies the brightness filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the brightness to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb BrightnessFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
+    }
     // 1. we turn from rgb to hsl
     // 2. linear modification of luminance
     // 3. we turn hsl back to rgb
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            QColor pixelColor = QColor::fromRgb(pixel);
-            int hsvLightness = qBound(0, pixelColor.value() + static_cast<int>(strength), 255);
-            pixelColor.setHsv(pixelColor.hsvHue(), pixelColor.hsvSaturation(), hsvLightness);
-            PixelHelper::setPixel(newImage, i, j, pixelColor.rgba());
-        }
-    }
-    return newImage;
+    QColor pixelColor = QColor::fromRgb(pixel);
+    int hsvLightness = qBound(0, pixelColor.value() + static_cast<int>(strength), 255);
+    pixelColor.setHsv(pixelColor.hsvHue(), pixelColor.hsvSaturation(), hsvLightness);
+    return pixelColor.rgba();
 }
 
 /**
@@ -65,3 +82,25 @@ QImage BrightnessFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the brightness filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void BrightnessFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Linear modification of the hsv value, only negative values are clamped
+    const float shift = static_cast<int>(strength) / 255.0f;
+    for (int i = 0; i < count; ++i) {
+        float* pixel = rgba + i * FloatImage::CHANNELS;
+        float hue, saturation, value;
+        FloatImage::toHsv(pixel, hue, saturation, value);
+        FloatImage::fromHsv(hue, saturation, qMax(0.0f, value + shift), pixel);
+    }
+}
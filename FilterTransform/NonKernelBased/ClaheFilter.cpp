@@ -0,0 +1,166 @@
+/**
+ * @class ClaheFilter
+ * @brief Contrast Limited Adaptive Histogram Equalisation Non-Kernel Implementation.
+ * @details The image is divided into a grid of tiles. Every tile equalises its own luma histogram,
+ * with bins clipped at a multiple of the mean count and the excess spread over all bins, so noise in flat areas is not amplified.
+ * Every pixel interpolates bilinearly between the look-up tables of the four nearest tile centres,
+ * so no tile borders are visible and the cost per pixel does not depend on the tile size.
+ * Tile histograms and output rows are both computed in parallel.
+ * The luma change is added to red, green and blue alike, which keeps the colour differences of every pixel.
+ */
+#include "ClaheFilter.h"
+#include "../../Utilities/ImageBufferPool.h"
+#include "../../Utilities/ImageHistogram.h"
+#include "../../Utilities/PixelHelper.h"
+#include <QThread>
+#include <QtConcurrent>
+#include <cmath>
+
+/**
+ * @brief Construct a new Clahe Filter:: Clahe Filter object
+ *
+ * @param tiles Tiles per side of the grid, 1..MAX_TILES.
+ * @param parent Passed to AbstractNonKernelBasedImageFilterTransform() constructor.
+ */
+ClaheFilter::ClaheFilter(int tiles, QObject* parent) : AbstractNonKernelBasedImageFilterTransform(parent), tiles(qBound(1, tiles, static_cast<int>(MAX_TILES)))
+{
+
+}
+
+/**
+ * @brief Returns the name of the filter.
+ *
+ * @return QString Name of the filter.
+ */
+QString ClaheFilter::getName() const
+{
+    return "CLAHE Filter";
+}
+
+/**
+ * @brief Gets new image after filter applied.
+ *
+ * @param image Original image to get new filter applied image.
+ * @param strength Clip limit as a multiple of the mean bin count, 1 leaves the image almost unchanged.
+ * @return QImage Filter applied image.
+ */
+QImage ClaheFilter::applyFilter(const QImage &image, double strength) const
+{
+    if (image.isNull() || strength <= 0) {
+        return QImage{image};
+    }
+    const QImage source = PixelHelper::toWorkingFormat(image);
+    const int width = source.width(), height = source.height();
+    const int tilesX = qMin(tiles, width), tilesY = qMin(tiles, height);
+    const int BINS = ImageHistogram::BINS;
+
+    // 1. One clipped, equalised look-up table per tile
+    QVector<int> tileIndices;
+    for (int t = 0; t < tilesX * tilesY; ++t) {
+        tileIndices.append(t);
+    }
+    QVector<uchar> tables(tilesX * tilesY * BINS);
+    uchar* tableData = tables.data();
+    QtConcurrent::blockingMap(tileIndices, [&](int t) {
+        const int tx = t % tilesX, ty = t / tilesX;
+        const int left = tx * width / tilesX, right = (tx + 1) * width / tilesX;
+        const int top = ty * height / tilesY, bottom = (ty + 1) * height / tilesY;
+        const int pixels = (right - left) * (bottom - top);
+
+        int counts[ImageHistogram::BINS] = {0};
+        for (int j = top; j < bottom; ++j) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(source.constScanLine(j));
+            for (int i = left; i < right; ++i) {
+                ++counts[ImageHistogram::luma(line[i])];
+            }
+        }
+
+        // Clip, then spread the excess evenly, the remainder one count per bin at a regular stride
+        const int limit = qMax(1, static_cast<int>(strength * pixels / BINS));
+        int excess = 0;
+        for (int value = 0; value < BINS; ++value) {
+            if (counts[value] > limit) {
+                excess += counts[value] - limit;
+                counts[value] = limit;
+            }
+        }
+        const int increment = excess / BINS;
+        const int remainder = excess % BINS;
+        for (int value = 0; value < BINS; ++value) {
+            counts[value] += increment;
+        }
+        if (remainder > 0) {
+            const int stride = qMax(1, BINS / remainder);
+            for (int value = 0, remaining = remainder; value < BINS && remaining > 0; value += stride, --remaining) {
+                ++counts[value];
+            }
+        }
+
+        uchar* table = tableData + t * BINS;
+        qint64 cumulative = 0;
+        for (int value = 0; value < BINS; ++value) {
+            cumulative += counts[value];
+            table[value] = static_cast<uchar>(qBound<qint64>(0, (cumulative * 255 + pixels / 2) / pixels, 255));
+        }
+    });
+
+    // 2. Neighbouring tile centres and weights per column and per row, in 8-bit fixed point
+    const auto neighbours = [](int length, int count, QVector<int>& first, QVector<int>& second, QVector<int>& weight) {
+        first.resize(length);
+        second.resize(length);
+        weight.resize(length);
+        const double tileLength = double(length) / count;
+        for (int p = 0; p < length; ++p) {
+            const double position = qBound(0.0, (p + 0.5) / tileLength - 0.5, double(count - 1));
+            first[p] = static_cast<int>(std::floor(position));
+            second[p] = qMin(first[p] + 1, count - 1);
+            weight[p] = static_cast<int>(std::lround((position - first[p]) * 256));
+        }
+    };
+    QVector<int> firstX, secondX, weightX, firstY, secondY, weightY;
+    neighbours(width, tilesX, firstX, secondX, weightX);
+    neighbours(height, tilesY, firstY, secondY, weightY);
+
+    // 3. Bilinear interpolation of the four tables, in bands of rows
+    QImage newImage = ImageBufferPool::acquireLike(source);
+    uchar* bits = newImage.bits();
+    const int bytesPerLine = newImage.bytesPerLine();
+    const int bandCount = qMin(height, qMax(1, QThread::idealThreadCount() * 4));
+    const int rowsPerBand = (height + bandCount - 1) / bandCount;
+    QVector<int> bands;
+    for (int firstRow = 0; firstRow < height; firstRow += rowsPerBand) {
+        bands.append(firstRow);
+    }
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        for (int j = firstRow; j < qMin(firstRow + rowsPerBand, height); ++j) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(source.constScanLine(j));
+            QRgb* target = reinterpret_cast<QRgb*>(bits + j * bytesPerLine);
+            const uchar* topRow = tableData + firstY[j] * tilesX * BINS;
+            const uchar* bottomRow = tableData + secondY[j] * tilesX * BINS;
+            const int wy = weightY[j];
+            for (int i = 0; i < width; ++i) {
+                const QRgb rgb = line[i];
+                const int luma = ImageHistogram::luma(rgb);
+                const int wx = weightX[i];
+                const int topValue = topRow[firstX[i] * BINS + luma] * (256 - wx) + topRow[secondX[i] * BINS + luma] * wx;
+                const int bottomValue = bottomRow[firstX[i] * BINS + luma] * (256 - wx) + bottomRow[secondX[i] * BINS + luma] * wx;
+                const int mapped = (topValue * (256 - wy) + bottomValue * wy + (1 << 15)) >> 16;
+                const int delta = mapped - luma;
+                target[i] = qRgba(qBound(0, qRed(rgb) + delta, 255), qBound(0, qGreen(rgb) + delta, 255),
+                                  qBound(0, qBlue(rgb) + delta, 255), qAlpha(rgb));
+            }
+        }
+    });
+    return newImage;
+}
+
+/**
+ * @brief Applies the filter with the default clip limit.
+ *
+ * @param image Original image to get new filter applied image.
+ * @return QImage Filter applied image.
+ */
+QImage ClaheFilter::applyFilter(const QImage &image) const
+{
+    return applyFilter(image, DEFAULT_CLIP_LIMIT);
+}
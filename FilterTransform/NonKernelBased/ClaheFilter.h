@@ -0,0 +1,24 @@
+#ifndef CLAHEFILTER_H
+#define CLAHEFILTER_H
+
+#include "../AbstractNonKernelBasedImageFilterTransform.h"
+
+class ClaheFilter : public AbstractNonKernelBasedImageFilterTransform
+{
+    Q_OBJECT
+public:
+    explicit ClaheFilter(int tiles = DEFAULT_TILES, QObject *parent = nullptr);
+    virtual QString getName() const override;
+    virtual QImage applyFilter(const QImage &img, double strength) const override;
+    virtual QImage applyFilter(const QImage &img) const override;
+
+public:
+    static const int DEFAULT_TILES = 8;                 //!< Tiles per side of the grid.
+    static const int MAX_TILES = 64;                    //!< Upper bound on the tiles per side.
+    static constexpr double DEFAULT_CLIP_LIMIT = 2.0;   //!< Bins are clipped at this multiple of the mean bin count.
+
+private:
+    int tiles;      //!< Tiles per side of the grid, fewer on images smaller than the grid.
+};
+
+#endif // CLAHEFILTER_H
@@ -4,6 +4,7 @@
  */
 
 #include "ContrastFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Contrast Filter:: Contrast Filter object
@@ -34,25 +35,53 @@ QString ContrastFilter::getName() const
  */
 QImage ContrastFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
     // This filter will be dealing with integer strength values
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
+    }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The contrast filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool ContrastFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief The contrast filter scales every channel on its own.
+ *
+ * @return true Always.
+ */
+bool ContrastFilter::isChannelSeparable() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the contrast filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the contrast to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb ContrastFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
     }
     // 1. calculate the contrast correction factor
     // 2. perform the actual contrast adjustment with the formula newrgb = factor * (rgb - 128) + 128
     // 3. Bound the resulting rgb between 0 and 255
     double correctionFactor = (259 * (static_cast<int>(strength) + 255)) / (255 * (259 - static_cast<int>(strength)));
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            int newRed = qBound(0, static_cast<int>(correctionFactor * (qRed(pixel) - 128) + 128), 255);
-            int newGreen = qBound(0, static_cast<int>(correctionFactor * (qGreen(pixel) - 128) + 128), 255);
-            int newBlue = qBound(0, static_cast<int>(correctionFactor * (qBlue(pixel) - 128) + 128), 255);
-            PixelHelper::setPixel(newImage, i, j, qRgb(newRed, newGreen, newBlue));
-        }
-    }
-    return newImage;
+    int newRed = qBound(0, static_cast<int>(correctionFactor * (qRed(pixel) - 128) + 128), 255);
+    int newGreen = qBound(0, static_cast<int>(correctionFactor * (qGreen(pixel) - 128) + 128), 255);
+    int newBlue = qBound(0, static_cast<int>(correctionFactor * (qBlue(pixel) - 128) + 128), 255);
+    return qRgb(newRed, newGreen, newBlue);
 }
 
 /**
@@ -65,3 +94,24 @@ QImage ContrastFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the contrast filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void ContrastFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Same correction factor as applyToPixel(), newrgb = factor * (rgb - 128/255) + 128/255
+    double correctionFactor = (259 * (static_cast<int>(strength) + 255)) / (255 * (259 - static_cast<int>(strength)));
+    const float factor = static_cast<float>(correctionFactor);
+    const float shift = (128.0f / 255.0f) * (1.0f - factor);
+    const float scale[FloatImage::CHANNELS] = {factor, factor, factor, 1.0f};
+    const float offset[FloatImage::CHANNELS] = {shift, shift, shift, 0.0f};
+    FloatImage::applyAffine(rgba, count, scale, offset);
+}
@@ -3,6 +3,7 @@
  * @brief Exposure Filter Non-Kernel Implementation.
  */
 #include "ExposureFilter.h"
+#include "../../Utilities/FloatImage.h"
 #include <QtMath>
 
 /**
@@ -34,25 +35,43 @@ QString ExposureFilter::getName() const
  */
 QImage ExposureFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
     // This filter will be dealing with integer strength values
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
+    }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The exposure filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool ExposureFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the exposure filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the exposure to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb ExposureFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
     }
     // 1. we turn from rgb to hsl
     // 2. modification of luminance, with formula newLight = oldLight * 2 ^ exposure compensation. Exposure compensation is simply strength/100
     // 3. we turn hsl back to rgb
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            QColor pixelColor = QColor::fromRgb(pixel);
-            double exposureCompensation = strength / 100;
-            int hsvLightness = qBound(0, static_cast<int>(pixelColor.value() * qPow(2, exposureCompensation)), 255);
-            pixelColor.setHsv(pixelColor.hsvHue(), pixelColor.hsvSaturation(), hsvLightness);
-            PixelHelper::setPixel(newImage, i, j, pixelColor.rgba());
-        }
-    }
-    return newImage;
+    QColor pixelColor = QColor::fromRgb(pixel);
+    double exposureCompensation = strength / 100;
+    int hsvLightness = qBound(0, static_cast<int>(pixelColor.value() * qPow(2, exposureCompensation)), 255);
+    pixelColor.setHsv(pixelColor.hsvHue(), pixelColor.hsvSaturation(), hsvLightness);
+    return pixelColor.rgba();
 }
 
 /**
@@ -65,3 +84,22 @@ QImage ExposureFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the exposure filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void ExposureFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Scaling the hsv value while keeping hue and saturation scales every colour channel by the same factor
+    const float factor = static_cast<float>(qPow(2, strength / 100));
+    const float scale[FloatImage::CHANNELS] = {factor, factor, factor, 1.0f};
+    const float offset[FloatImage::CHANNELS] = {0.0f, 0.0f, 0.0f, 0.0f};
+    FloatImage::applyAffine(rgba, count, scale, offset);
+}
@@ -0,0 +1,299 @@
+/**
+ * @class FastMarchingInpainting
+ * @brief Fast marching (Telea) image inpainting implementation.
+ * @details The hole is filled from its boundary inwards in a single ordered sweep.
+ * The distance T of every hole pixel to the boundary is computed with the fast marching method,
+ * a priority queue always advances the pixel with the smallest T next.
+ * When a pixel is reached its color is estimated once from the already known pixels within radius,
+ * weighted by direction (along the normal of the front), distance and level set proximity.
+ * All work is limited to the bounding box of the hole grown by the radius, so apart from finding that box
+ * (one bit per pixel, tested a word at a time, see BitMask) the cost does not grow with the size of the image.
+ * The image gradient term of the original method is left out.
+ */
+
+#include "FastMarchingInpainting.h"
+#include "../../Utilities/PixelHelper.h"
+
+#include <cmath>
+#include <queue>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace {
+const float INF = 1.0e6f;   //!< Distance of pixels the front has not reached yet.
+const int NEIGHBOURS[4][2] = {{-1, 0}, {0, -1}, {1, 0}, {0, 1}};
+}
+
+/**
+ * @brief Construct a new Fast Marching Inpainting:: Fast Marching Inpainting object
+ *
+ * @param radius Radius of the neighbourhood a filled pixel is estimated from.
+ * @param parent Passed to AbstractNonKernelBasedImageFilterTransform() constructor.
+ */
+FastMarchingInpainting::FastMarchingInpainting(int radius, QObject *parent) : AbstractNonKernelBasedImageFilterTransform(parent), radius(radius)
+{
+
+}
+
+/**
+ * @brief Returns the name of the filter.
+ *
+ * @return QString Name of the filter.
+ */
+QString FastMarchingInpainting::getName() const
+{
+    return "Fast Marching Inpainting";
+}
+
+/**
+ * @brief Gets new image after effect applied.
+ *
+ * @param img Original image to get new filter applied image.
+ * @param size Radius of the neighbourhood a filled pixel is estimated from.
+ * @return QImage Filter applied image.
+ */
+QImage FastMarchingInpainting::applyFilter(const QImage &img, int size, double)
+{
+    radius = qMax(1, size);
+    return applyFilter(img);
+}
+
+/**
+ * @brief This is an overloaded function.
+ *
+ * @param img Original image to get new filter applied image.
+ * @return QImage Filter applied image.
+ */
+QImage FastMarchingInpainting::applyFilter(const QImage &img, double) const
+{
+    return applyFilter(img);
+}
+
+/**
+ * @brief Fills the masked region of img with the fast marching method.
+ *
+ * @param img Original image to get new filter applied image.
+ * @return QImage Filter applied image.
+ */
+QImage FastMarchingInpainting::applyFilter(const QImage &img) const
+{
+    Q_ASSERT(img.depth() == 32);
+    QImage newImage{img};
+
+    // Only the hole and the known pixels within radius of it are ever read, all coordinates below are relative to this window
+    const QRect hole = mask.boundingBox().intersected(img.rect());
+    if (hole.isEmpty())
+    {
+        return newImage;
+    }
+    const QRect window = hole.adjusted(-radius - 1, -radius - 1, radius + 1, radius + 1).intersected(img.rect());
+    const int width = window.width(), height = window.height();
+
+    QVector<uchar> flags(width * height, KNOWN);
+    QVector<float> distance(width * height, 0.0f);
+    bool empty = true;
+    for (int j = hole.top(); j <= hole.bottom(); ++j)
+    {
+        for (int i = hole.left(); i <= hole.right(); ++i)
+        {
+            if (mask.testBit(i, j))
+            {
+                const int index = (j - window.top()) * width + (i - window.left());
+                flags[index] = INSIDE;
+                distance[index] = INF;
+                empty = false;
+            }
+        }
+    }
+    if (empty)
+    {
+        return newImage;
+    }
+
+    // The initial band is every known pixel next to the hole. Ties are broken by index, so the sweep is deterministic.
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> narrowBand;
+    for (int j = 0; j < height; ++j)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            if (flags[j * width + i] != KNOWN)
+            {
+                continue;
+            }
+            for (const auto& neighbour : NEIGHBOURS)
+            {
+                int x = i + neighbour[0], y = j + neighbour[1];
+                if (0 <= x && x < width && 0 <= y && y < height && flags[y * width + x] == INSIDE)
+                {
+                    flags[j * width + i] = BAND;
+                    narrowBand.push(Entry(0.0f, j * width + i));
+                    break;
+                }
+            }
+        }
+    }
+
+    // March the front inwards, always advancing the band pixel closest to the original boundary.
+    while (!narrowBand.empty())
+    {
+        const int index = narrowBand.top().second;
+        narrowBand.pop();
+        if (flags[index] == KNOWN)
+        {
+            continue;   // stale entry, the pixel was reached with a smaller distance already
+        }
+        flags[index] = KNOWN;
+        const int i = index % width, j = index / width;
+        for (const auto& neighbour : NEIGHBOURS)
+        {
+            int x = i + neighbour[0], y = j + neighbour[1];
+            if (x < 0 || x >= width || y < 0 || y >= height || flags[y * width + x] == KNOWN)
+            {
+                continue;
+            }
+            float newDistance = qMin(qMin(solveEikonal(distance, flags, width, height, x - 1, y, x, y - 1),
+                                          solveEikonal(distance, flags, width, height, x + 1, y, x, y - 1)),
+                                     qMin(solveEikonal(distance, flags, width, height, x - 1, y, x, y + 1),
+                                          solveEikonal(distance, flags, width, height, x + 1, y, x, y + 1)));
+            if (flags[y * width + x] == INSIDE)
+            {
+                distance[y * width + x] = newDistance;
+                PixelHelper::setPixel(newImage, window.left() + x, window.top() + y, inpaintPixel(newImage, window, distance, flags, x, y));
+                flags[y * width + x] = BAND;
+                narrowBand.push(Entry(newDistance, y * width + x));
+            }
+            else if (newDistance < distance[y * width + x])
+            {
+                distance[y * width + x] = newDistance;
+                narrowBand.push(Entry(newDistance, y * width + x));
+            }
+        }
+    }
+    return newImage;
+}
+
+/**
+ * @brief Solves the eikonal equation |grad T| = 1 at a pixel from two of its neighbours.
+ *
+ * @param distance Distances of all pixels in the window.
+ * @param flags Flags of all pixels in the window.
+ * @param width Window width.
+ * @param height Window height.
+ * @param x1 Horizontal neighbour x.
+ * @param y1 Horizontal neighbour y.
+ * @param x2 Vertical neighbour x.
+ * @param y2 Vertical neighbour y.
+ * @return float Distance estimate, INF if neither neighbour has a distance.
+ */
+float FastMarchingInpainting::solveEikonal(const QVector<float>& distance, const QVector<uchar>& flags, int width, int height, int x1, int y1, int x2, int y2)
+{
+    auto valueAt = [&](int x, int y) {
+        if (x < 0 || x >= width || y < 0 || y >= height || flags[y * width + x] == INSIDE)
+        {
+            return INF;
+        }
+        return distance[y * width + x];
+    };
+    const float t1 = valueAt(x1, y1), t2 = valueAt(x2, y2);
+    const float smaller = qMin(t1, t2);
+    if (smaller >= INF)
+    {
+        return INF;
+    }
+    if (t1 >= INF || t2 >= INF || (t1 - t2) * (t1 - t2) >= 2.0f)
+    {
+        return 1.0f + smaller;
+    }
+    const float r = std::sqrt(2.0f - (t1 - t2) * (t1 - t2));
+    float s = (t1 + t2 - r) / 2.0f;
+    if (s >= t1 && s >= t2)
+    {
+        return s;
+    }
+    s += r;
+    if (s >= t1 && s >= t2)
+    {
+        return s;
+    }
+    return 1.0f + smaller;
+}
+
+/**
+ * @brief Estimates the color of a hole pixel from the known pixels within radius.
+ *
+ * @param image Image with the known pixels.
+ * @param window Region of image that distance and flags cover.
+ * @param distance Distances of the pixels in window.
+ * @param flags Flags of the pixels in window.
+ * @param x Pixel x, relative to window.
+ * @param y Pixel y, relative to window.
+ * @return QRgb Estimated color.
+ */
+QRgb FastMarchingInpainting::inpaintPixel(const QImage& image, const QRect& window, const QVector<float>& distance, const QVector<uchar>& flags, int x, int y) const
+{
+    const int width = window.width(), height = window.height();
+    auto known = [&](int i, int j) {
+        return 0 <= i && i < width && 0 <= j && j < height && flags[j * width + i] != INSIDE;
+    };
+
+    // Normal of the front, from central differences of the distance where available
+    const float t = distance[y * width + x];
+    float gradientX = 0.0f, gradientY = 0.0f;
+    if (known(x + 1, y) && known(x - 1, y)) gradientX = (distance[y * width + x + 1] - distance[y * width + x - 1]) / 2.0f;
+    else if (known(x + 1, y)) gradientX = distance[y * width + x + 1] - t;
+    else if (known(x - 1, y)) gradientX = t - distance[y * width + x - 1];
+    if (known(x, y + 1) && known(x, y - 1)) gradientY = (distance[(y + 1) * width + x] - distance[(y - 1) * width + x]) / 2.0f;
+    else if (known(x, y + 1)) gradientY = distance[(y + 1) * width + x] - t;
+    else if (known(x, y - 1)) gradientY = t - distance[(y - 1) * width + x];
+
+    double red = 0, green = 0, blue = 0, totalWeight = 0;
+    for (int j = y - radius; j <= y + radius; ++j)
+    {
+        for (int i = x - radius; i <= x + radius; ++i)
+        {
+            const int dx = x - i, dy = y - j;
+            const int squaredLength = dx * dx + dy * dy;
+            if (squaredLength == 0 || squaredLength > radius * radius || !known(i, j))
+            {
+                continue;
+            }
+            const float length = std::sqrt(static_cast<float>(squaredLength));
+            const double direction = qMax(1.0e-6, static_cast<double>(qAbs(dx * gradientX + dy * gradientY) / length));
+            const double proximity = 1.0 / squaredLength;
+            const double level = 1.0 / (1.0 + qAbs(distance[j * width + i] - t));
+            const double weight = direction * proximity * level;
+            QRgb pixel = PixelHelper::getPixel(image, window.left() + i, window.top() + j);
+            red += weight * qRed(pixel);
+            green += weight * qGreen(pixel);
+            blue += weight * qBlue(pixel);
+            totalWeight += weight;
+        }
+    }
+    if (totalWeight <= 0)
+    {
+        return PixelHelper::getPixel(image, window.left() + x, window.top() + y);
+    }
+    return qRgb(qBound(0, qRound(red / totalWeight), 255),
+                qBound(0, qRound(green / totalWeight), 255),
+                qBound(0, qRound(blue / totalWeight), 255));
+}
+
+/**
+ * @brief Returns image mask.
+ *
+ * @return QImage
+ */
+QImage FastMarchingInpainting::getMask() {
+    return mask.toImage(qRgb(255, 255, 255), qRgb(0, 0, 0));
+}
+
+/**
+ * @brief Sets image mask.
+ *
+ * @param mask New image to set as inpainting mask, non-black pixels are filled.
+ */
+void FastMarchingInpainting::setMask(const QImage &mask) {
+    this->mask = BitMask::fromImage(mask, qRgb(0, 0, 0));
+}
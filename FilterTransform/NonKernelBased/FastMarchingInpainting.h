@@ -0,0 +1,33 @@
+#ifndef FASTMARCHINGINPAINTING_H
+#define FASTMARCHINGINPAINTING_H
+
+#include "../AbstractNonKernelBasedImageFilterTransform.h"
+#include "../../Utilities/BitMask.h"
+
+#include <QVector>
+
+class FastMarchingInpainting : public AbstractNonKernelBasedImageFilterTransform
+{
+    Q_OBJECT
+public:
+    explicit FastMarchingInpainting(int radius = 5, QObject *parent = nullptr);
+    virtual QString getName() const override;
+    virtual QImage applyFilter(const QImage &img, int size, double strength) override;
+    virtual QImage applyFilter(const QImage &img, double strength) const override;
+    virtual QImage applyFilter(const QImage &img) const override;
+
+    virtual QImage getMask();
+    virtual void setMask(const QImage& mask);
+
+private:
+    enum Flag : uchar { KNOWN, BAND, INSIDE };
+
+    static float solveEikonal(const QVector<float>& distance, const QVector<uchar>& flags, int width, int height, int x1, int y1, int x2, int y2);
+    QRgb inpaintPixel(const QImage& image, const QRect& window, const QVector<float>& distance, const QVector<uchar>& flags, int x, int y) const;
+
+private:
+    BitMask mask;   //!< Inpainting mask, set pixels are filled.
+    int radius;     //!< Radius of the neighbourhood a filled pixel is estimated from.
+};
+
+#endif // FASTMARCHINGINPAINTING_H
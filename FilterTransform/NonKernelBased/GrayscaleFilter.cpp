@@ -3,6 +3,7 @@
  * @brief Grayscale Filter Non-Kernel Implementation.
  */
 #include "GrayscaleFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Grayscale Filter:: Grayscale Filter object
@@ -40,21 +41,48 @@ QImage GrayscaleFilter::applyFilter(const QImage &image, double) const
  *
  * @param image Original image to get new filter applied image.
  *
- * Get qRgb of each pixel with PixelHelper::getPixel
- * Average R, G, and B of each pixel
- * Use the value to set the new image with PixelHelper::setPixel
+ * Average R, G, and B of each pixel with applyToPixel()
  *
  * @return QImage Filter applied image.
  */
 QImage GrayscaleFilter::applyFilter(const QImage &image) const
 {
-    QImage newImage{image};
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            int avg = (qRed(pixel) + qGreen(pixel) + qBlue(pixel)) / 3;
-            PixelHelper::setPixel(newImage, i, j, qRgb(avg, avg, avg));
-        }
+    return applyPointOperation(image, 1.0);
+}
+
+/**
+ * @brief The grayscale filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool GrayscaleFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the grayscale filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @return QRgb Gray pixel, the average of R, G and B.
+ */
+QRgb GrayscaleFilter::applyToPixel(QRgb pixel, double) const
+{
+    int avg = (qRed(pixel) + qGreen(pixel) + qBlue(pixel)) / 3;
+    return qRgb(avg, avg, avg);
+}
+
+/**
+ * @brief Applies the grayscale filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ */
+void GrayscaleFilter::applyToFloatPixels(float *rgba, int count, double) const
+{
+    for (int i = 0; i < count; ++i) {
+        float* pixel = rgba + i * FloatImage::CHANNELS;
+        float avg = (pixel[0] + pixel[1] + pixel[2]) / 3.0f;
+        pixel[0] = pixel[1] = pixel[2] = avg;
     }
-    return newImage;
 }
@@ -11,6 +11,9 @@ public:
     virtual QString getName() const override;
     virtual QImage applyFilter(const QImage &img, double strength) const override;
     virtual QImage applyFilter(const QImage &img) const override;
+    virtual bool isPointOperation() const override;
+    virtual QRgb applyToPixel(QRgb pixel, double strength) const override;
+    virtual void applyToFloatPixels(float *rgba, int count, double strength) const override;
 };
 
 #endif // GRAYSCALEFILTER_H
@@ -3,6 +3,7 @@
  * @brief Hue Filter Non-Kernel Implementation.
  */
 #include "HueFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Hue Filter:: Hue Filter object
@@ -30,35 +31,50 @@ QString HueFilter::getName() const
  * @param image Original image to get new filter applied image.
  * @param strength Strength of Hue level to be applied
  *
- * Get qRgb of each pixel with PixelHelper::getPixel
+ * For each pixel, applyToPixel() does the following:
  * Convert qRgb into QColor format
  * Change the Hue Value for each pixel and set with setHsv
- * Use the value to set the new image with PixelHelper::setPixel
  *
  * @return QImage Filter applied image.
  */
 QImage HueFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
     // This filter will be dealing with integer strength values
-
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
     }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The hue filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool HueFilter::isPointOperation() const
+{
+    return true;
+}
 
+/**
+ * @brief Applies the hue filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the hue to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb HueFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
+    }
     // 1. we turn from rgb to hue
     // 2. simple hsv filter, adds the strength directly to the hue value, but with upper and lower bounds
     // 3. we turn hue back to rgb
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            QColor pixelColor = QColor::fromRgb(pixel);
-            int hsvHue = qBound(0, pixelColor.hsvHue() + static_cast<int>(strength), 359);
-            pixelColor.setHsv(hsvHue, pixelColor.hsvSaturation(), pixelColor.value());
-            PixelHelper::setPixel(newImage, i, j, pixelColor.rgba());
-        }
-    }
-    return newImage;
+    QColor pixelColor = QColor::fromRgb(pixel);
+    int hsvHue = qBound(0, pixelColor.hsvHue() + static_cast<int>(strength), 359);
+    pixelColor.setHsv(hsvHue, pixelColor.hsvSaturation(), pixelColor.value());
+    return pixelColor.rgba();
 }
 
 /**
@@ -71,3 +87,27 @@ QImage HueFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the hue filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void HueFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Adds the strength to the hue of chromatic pixels, with the same bounds as applyToPixel()
+    for (int i = 0; i < count; ++i) {
+        float* pixel = rgba + i * FloatImage::CHANNELS;
+        float hue, saturation, value;
+        FloatImage::toHsv(pixel, hue, saturation, value);
+        if (hue < 0.0f) {
+            continue;
+        }
+        FloatImage::fromHsv(qBound(0.0f, hue + static_cast<int>(strength), 359.0f), saturation, value, pixel);
+    }
+}
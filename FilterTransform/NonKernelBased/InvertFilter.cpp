@@ -3,6 +3,7 @@
  * @brief Invert Filter Non-Kernel Implementation.
  */
 #include "InvertFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Invert Filter:: Invert Filter object
@@ -50,3 +51,48 @@ QImage InvertFilter::applyFilter(const QImage &image) const
     newImage.invertPixels();
     return newImage;
 }
+
+/**
+ * @brief The invert filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool InvertFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief The invert filter inverts every channel on its own.
+ *
+ * @return true Always.
+ */
+bool InvertFilter::isChannelSeparable() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the invert filter to a single pixel.
+ * @details Same result as QImage::invertPixels(), alpha is kept.
+ *
+ * @param pixel Original pixel.
+ * @return QRgb Inverted pixel.
+ */
+QRgb InvertFilter::applyToPixel(QRgb pixel, double) const
+{
+    return qRgba(255 - qRed(pixel), 255 - qGreen(pixel), 255 - qBlue(pixel), qAlpha(pixel));
+}
+
+/**
+ * @brief Applies the invert filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ */
+void InvertFilter::applyToFloatPixels(float *rgba, int count, double) const
+{
+    const float scale[FloatImage::CHANNELS] = {-1.0f, -1.0f, -1.0f, 1.0f};
+    const float offset[FloatImage::CHANNELS] = {1.0f, 1.0f, 1.0f, 0.0f};
+    FloatImage::applyAffine(rgba, count, scale, offset);
+}
@@ -4,6 +4,60 @@
  */
 #include "MagicWand.h"
 #include <QtMath>
+#include <QtConcurrent>
+
+namespace {
+/**
+ * @brief Checks whether two colors are within threshold of each other in every channel. Removed (transparent) pixels never are.
+ */
+bool similar(QRgb a, QRgb b, int threshold)
+{
+    if (a == Qt::transparent || b == Qt::transparent) {
+        return false;
+    }
+    return qAbs(qRed(a) - qRed(b)) <= threshold
+            && qAbs(qGreen(a) - qGreen(b)) <= threshold
+            && qAbs(qBlue(a) - qBlue(b)) <= threshold;
+}
+
+/**
+ * @brief Finds the root of index, halving the path on the way.
+ */
+int findRoot(QVector<int>& parent, int index)
+{
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+/**
+ * @brief Merges the sets of a and b, the smaller index becomes the root so the labels do not depend on the merge order.
+ */
+void unite(QVector<int>& parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+/**
+ * @brief Row band starts for a parallel map over the rows of an image.
+ */
+QVector<int> rowBands(int height, int rowsPerBand)
+{
+    QVector<int> bands((height + rowsPerBand - 1) / rowsPerBand);
+    for (int i = 0; i < bands.size(); ++i) {
+        bands[i] = i * rowsPerBand;
+    }
+    return bands;
+}
+}
 
 /**
  * @brief Construct a new Magic Wand:: Magic Wand object
@@ -53,19 +107,384 @@ QImage MagicWand::applyFilter(const QImage &image) const
  * @param threshold Tolerance for Magic Wand
  *
  * Construct newImage from image
- * Apply the forestFire algorithm starting from the (x,y) pixel to newImage
+ * Set every pixel of the selection starting from the (x,y) pixel to transparent
+ * A matching incremental selection (see beginSelection()) is reused instead of selecting again
  * @return QImage Filter applied image - newImage
  */
-QImage MagicWand::crop(const QImage &image, int x, int y, int threshold)
+QImage MagicWand::crop(const QImage &image, int x, int y, int threshold, SelectionMode mode)
 {
     QImage newImage{image};
+    BitMask selection;
+    switch (mode) {
+    case SelectionMode::CONTIGUOUS:
+        selection = hasSelection(image, x, y) ? updateSelection(threshold) : select(image, x, y, threshold);
+        break;
+    case SelectionMode::GLOBAL:
+        selection = selectGlobal(image, x, y, threshold);
+        break;
+    case SelectionMode::COMPONENTS:
+        selection = selectComponent(image, x, y, threshold);
+        break;
+    }
+    selection.forEachSetBit([&newImage](int i, int j) {
+        PixelHelper::setPixel(newImage, i, j, Qt::transparent);
+    });
+
+    // The other components are unaffected by removing one, keep the labels valid for the cropped image
+    if (mode == SelectionMode::COMPONENTS && hasComponentIndex(image)) {
+        selection.forEachSetBit([this, &newImage](int i, int j) {
+            componentIndex.labels[j * newImage.width() + i] = -1;
+        });
+        componentIndex.key = newImage.cacheKey();
+    }
+    // Likewise the segments, those that lost pixels are no longer selected at once
+    if (superpixelIndex && superpixelIndex->isBuiltFrom(image)) {
+        superpixelIndex.reset(new SuperpixelIndex(superpixelIndex->afterRemoving(newImage, selection)));
+    }
+    return newImage;
+}
+
+/**
+ * @brief Selects the region connected to the (x,y) pixel whose colors are within threshold of it.
+ * @details Uses the superpixel index if one was set for this image, see setSuperpixelIndex().
+ *
+ * @param image Image to select from.
+ * @param x Position of pixel from the top edge
+ * @param y Position of pixel from the left edge
+ * @param threshold Tolerance for Magic Wand
+ * @return BitMask Selection with the size of image, e.g. to be used as a scissors or inpainting mask.
+ */
+BitMask MagicWand::select(const QImage &image, int x, int y, int threshold)
+{
+    BitMask selection(image.width(), image.height());
+    if (x < 0 || x >= image.width() || y < 0 || y >= image.height())
+        return selection;
     QRgb originalColor = PixelHelper::getPixel(image, x, y);
     originalColorRed = qRed(originalColor);
     originalColorGreen = qGreen(originalColor);
     originalColorBlue = qBlue(originalColor);
     this->threshold = threshold;
-    forestFire(newImage, x, y);
-    return newImage;
+    if (superpixelIndex && superpixelIndex->isBuiltFrom(image))
+        forestFireSegments(image, *superpixelIndex, selection, x, y);
+    else
+        forestFire(image, selection, x, y);
+    return selection;
+}
+
+/**
+ * @brief Selects every pixel of the image whose color is within threshold of the (x,y) pixel, connected or not.
+ * @details Row bands are tested in parallel, each row builds its selection 64 pixels (one word) at a time.
+ *
+ * @param image Image to select from.
+ * @param x Position of pixel from the top edge
+ * @param y Position of pixel from the left edge
+ * @param threshold Tolerance for Magic Wand
+ * @return BitMask Selection with the size of image.
+ */
+BitMask MagicWand::selectGlobal(const QImage &image, int x, int y, int threshold)
+{
+    BitMask selection(image.width(), image.height());
+    if (x < 0 || x >= image.width() || y < 0 || y >= image.height())
+        return selection;
+    const QRgb originalColor = PixelHelper::getPixel(image, x, y);
+    const int width = image.width(), height = image.height();
+    QVector<int> bands = rowBands(height, ROWS_PER_BAND);
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        for (int j = firstRow; j < qMin(firstRow + ROWS_PER_BAND, height); ++j) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(j));
+            quint64* row = selection.row(j);
+            for (int w = 0; w < selection.wordsPerRow(); ++w) {
+                quint64 word = 0;
+                const int begin = w * BitMask::WORD_BITS, end = qMin(begin + BitMask::WORD_BITS, width);
+                for (int i = begin; i < end; ++i) {
+                    word |= quint64(similar(originalColor, line[i], threshold)) << (i - begin);
+                }
+                row[w] = word;
+            }
+        }
+    });
+    return selection;
+}
+
+/**
+ * @brief Selects the connected component of the (x,y) pixel.
+ * @details Components connect 4-neighbours whose colors are within threshold of each other.
+ * They are labelled for the whole image once, later clicks on the same image with the same threshold are lookups.
+ *
+ * @param image Image to select from.
+ * @param x Position of pixel from the top edge
+ * @param y Position of pixel from the left edge
+ * @param threshold Tolerance for Magic Wand
+ * @return BitMask Selection with the size of image.
+ */
+BitMask MagicWand::selectComponent(const QImage &image, int x, int y, int threshold)
+{
+    BitMask selection(image.width(), image.height());
+    if (x < 0 || x >= image.width() || y < 0 || y >= image.height())
+        return selection;
+    const ComponentIndex& index = componentIndexFor(image, threshold);
+    const int width = image.width(), height = image.height();
+    const int label = index.labels[y * width + x];
+    if (label < 0)
+        return selection;
+    QVector<int> bands = rowBands(height, ROWS_PER_BAND);
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        for (int j = firstRow; j < qMin(firstRow + ROWS_PER_BAND, height); ++j) {
+            const int* labels = index.labels.constData() + j * width;
+            quint64* row = selection.row(j);
+            for (int w = 0; w < selection.wordsPerRow(); ++w) {
+                quint64 word = 0;
+                const int begin = w * BitMask::WORD_BITS, end = qMin(begin + BitMask::WORD_BITS, width);
+                for (int i = begin; i < end; ++i) {
+                    word |= quint64(labels[i] == label) << (i - begin);
+                }
+                row[w] = word;
+            }
+        }
+    });
+    return selection;
+}
+
+/**
+ * @brief Returns the component labels of image, computing them only if image or threshold changed.
+ *
+ * @param image Image to label.
+ * @param threshold Tolerance for Magic Wand
+ * @return const MagicWand::ComponentIndex& Labels of image.
+ */
+const MagicWand::ComponentIndex& MagicWand::componentIndexFor(const QImage &image, int threshold)
+{
+    if (componentIndex.threshold != threshold || !hasComponentIndex(image)) {
+        componentIndex.key = image.cacheKey();
+        componentIndex.size = image.size();
+        componentIndex.threshold = threshold;
+        componentIndex.labels = labelComponents(image, threshold);
+    }
+    return componentIndex;
+}
+
+/**
+ * @brief Checks whether the component labels belong to this version of image.
+ * @details Versions are told apart by QImage::cacheKey(), which changes whenever the pixels change, so no pixels are compared.
+ *
+ * @param image Image to check.
+ * @return true The labels of image are kept, for some threshold.
+ * @return false No labels, or labels of another image.
+ */
+bool MagicWand::hasComponentIndex(const QImage &image) const
+{
+    return !componentIndex.labels.isEmpty() && componentIndex.key == image.cacheKey() && componentIndex.size == image.size();
+}
+
+/**
+ * @brief Takes over the component labels of another magic wand, e.g. of the workspace the image was cropped in.
+ *
+ * @param other Magic wand to take the labels from, it keeps none.
+ */
+void MagicWand::takeComponentIndex(MagicWand &other)
+{
+    componentIndex = other.componentIndex;
+    other.releaseComponentIndex();
+}
+
+/**
+ * @brief Frees the component labels, 4 bytes per pixel.
+ */
+void MagicWand::releaseComponentIndex()
+{
+    componentIndex = ComponentIndex();
+}
+
+/**
+ * @brief Labels the connected components of an image with a parallel union-find.
+ * @details Every row band unites its pixels in parallel, bands only touch their own pixels.
+ * The seams between bands are then united sequentially, and the labels are resolved in parallel.
+ * The root of a set is always its smallest pixel index, so the labels are deterministic.
+ *
+ * @param image Image to label.
+ * @param threshold Tolerance for Magic Wand
+ * @return QVector<int> Per pixel, the smallest pixel index of its component, -1 for removed (transparent) pixels.
+ */
+QVector<int> MagicWand::labelComponents(const QImage &image, int threshold)
+{
+    const int width = image.width(), height = image.height();
+    QVector<int> parent(width * height);
+    QVector<int> bands = rowBands(height, ROWS_PER_BAND);
+    auto pixel = [&image](int i, int j) {
+        return reinterpret_cast<const QRgb*>(image.constScanLine(j))[i];
+    };
+
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        const int lastRow = qMin(firstRow + ROWS_PER_BAND, height);
+        for (int j = firstRow; j < lastRow; ++j) {
+            for (int i = 0; i < width; ++i) {
+                parent[j * width + i] = j * width + i;
+            }
+        }
+        for (int j = firstRow; j < lastRow; ++j) {
+            for (int i = 0; i < width; ++i) {
+                if (i + 1 < width && similar(pixel(i, j), pixel(i + 1, j), threshold)) {
+                    unite(parent, j * width + i, j * width + i + 1);
+                }
+                if (j + 1 < lastRow && similar(pixel(i, j), pixel(i, j + 1), threshold)) {
+                    unite(parent, j * width + i, (j + 1) * width + i);
+                }
+            }
+        }
+    });
+
+    for (int b = 1; b < bands.size(); ++b) {
+        const int j = bands[b];
+        for (int i = 0; i < width; ++i) {
+            if (similar(pixel(i, j - 1), pixel(i, j), threshold)) {
+                unite(parent, (j - 1) * width + i, j * width + i);
+            }
+        }
+    }
+
+    QVector<int> labels(width * height);
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        for (int j = firstRow; j < qMin(firstRow + ROWS_PER_BAND, height); ++j) {
+            for (int i = 0; i < width; ++i) {
+                int root = j * width + i;
+                while (parent[root] != root) {
+                    root = parent[root];
+                }
+                labels[j * width + i] = pixel(i, j) == Qt::transparent ? -1 : root;
+            }
+        }
+    });
+    return labels;
+}
+
+/**
+ * @brief Starts an incremental contiguous selection from the (x,y) pixel, for scrubbing the threshold.
+ * @details Instead of flood filling from scratch for every threshold, the selection keeps its frontier:
+ * every unselected neighbour of the selection is queued at the smallest threshold that would include it,
+ * i.e. the largest color distance to the clicked pixel along its best path.
+ * Raising the threshold drains the queue up to the new threshold, lowering it removes the most recently joined pixels,
+ * which are exactly the ones above the new threshold, and queues them again.
+ * At every threshold the selection equals select() with that threshold.
+ * If a superpixel index was set for this image (see setSuperpixelIndex()), a reached segment whose whole color range
+ * is within the level it was reached at joins at once, and only its border pixels queue their neighbours.
+ *
+ * @param image Image to select from.
+ * @param x Position of pixel from the top edge
+ * @param y Position of pixel from the left edge
+ */
+void MagicWand::beginSelection(const QImage &image, int x, int y)
+{
+    selectionImage = image;
+    selectionSeed = QPoint(x, y);
+    selectionSegments = superpixelIndex && superpixelIndex->isBuiltFrom(image) ? superpixelIndex : QSharedPointer<const SuperpixelIndex>();
+    incrementalSelection = BitMask(image.width(), image.height());
+    frontier = QVector<QVector<int>>(MAX_LEVEL + 1);
+    selectionOrder.clear();
+    selectionLevels.clear();
+    changedPixels.clear();
+    if (x < 0 || x >= image.width() || y < 0 || y >= image.height())
+        return;
+    QRgb originalColor = PixelHelper::getPixel(image, x, y);
+    originalColorRed = qRed(originalColor);
+    originalColorGreen = qGreen(originalColor);
+    originalColorBlue = qBlue(originalColor);
+    if (seedDistance(y * image.width() + x) <= MAX_LEVEL)
+        frontier[0].append(y * image.width() + x);
+}
+
+/**
+ * @brief Updates the incremental selection to a new threshold.
+ * @details The pixels that joined or left the selection are listed by selectionChanges() afterwards.
+ *
+ * @param threshold Tolerance for Magic Wand
+ * @return const BitMask& Selection at threshold.
+ */
+const BitMask& MagicWand::updateSelection(int threshold)
+{
+    threshold = qBound(0, threshold, static_cast<int>(MAX_LEVEL));
+    const int width = selectionImage.width();
+    changedPixels.clear();
+
+    // Shrink: the most recently joined pixels have the largest levels
+    while (!selectionOrder.isEmpty() && selectionLevels.last() > threshold) {
+        const int index = selectionOrder.takeLast();
+        const int level = selectionLevels.takeLast();
+        incrementalSelection.setBit(index % width, index / width, false);
+        frontier[level].append(index);
+        changedPixels.append(index);
+    }
+
+    auto join = [&](int i, int j, int level) {
+        if (incrementalSelection.testBit(i, j))
+            return;
+        incrementalSelection.setBit(i, j);
+        selectionOrder.append(j * width + i);
+        selectionLevels.append(static_cast<uchar>(level));
+        changedPixels.append(j * width + i);
+    };
+    auto queueNeighbours = [&](int i, int j, int level) {
+        const int neighbours[4][2] = {{i + 1, j}, {i - 1, j}, {i, j + 1}, {i, j - 1}};
+        for (const auto& neighbour : neighbours) {
+            if (neighbour[0] < 0 || neighbour[0] >= width || neighbour[1] < 0 || neighbour[1] >= selectionImage.height()
+                    || incrementalSelection.testBit(neighbour[0], neighbour[1]))
+                continue;
+            const int neighbourIndex = neighbour[1] * width + neighbour[0];
+            const int neighbourLevel = qMax(level, seedDistance(neighbourIndex));
+            if (neighbourLevel <= MAX_LEVEL)
+                frontier[neighbourLevel].append(neighbourIndex);
+        }
+    };
+    const QRgb originalColor = qRgb(originalColorRed, originalColorGreen, originalColorBlue);
+
+    // Grow: drain the frontier in increasing level order, a pixel joins at the level it was reached with
+    for (int level = 0; level <= threshold; ++level) {
+        while (!frontier[level].isEmpty()) {
+            const int index = frontier[level].takeLast();
+            const int i = index % width, j = index / width;
+            if (incrementalSelection.testBit(i, j))
+                continue;
+            if (selectionSegments) {
+                // A 4-connected segment whose whole color range is within level joins at once, the fire continues from its border
+                const int label = selectionSegments->label(i, j);
+                if (selectionSegments->isWithinThreshold(label, originalColor, level)) {
+                    selectionSegments->forEachPixel(label, [&](int x, int y) { join(x, y, level); });
+                    selectionSegments->forEachBorderPixel(label, [&](int x, int y) { queueNeighbours(x, y, level); });
+                    continue;
+                }
+            }
+            join(i, j, level);
+            queueNeighbours(i, j, level);
+        }
+    }
+    return incrementalSelection;
+}
+
+/**
+ * @brief Checks whether the incremental selection was started on image at (x,y).
+ *
+ * @param image Image to select from.
+ * @param x Position of pixel from the top edge
+ * @param y Position of pixel from the left edge
+ * @return true updateSelection() can be used instead of select().
+ * @return false No matching incremental selection.
+ */
+bool MagicWand::hasSelection(const QImage &image, int x, int y) const
+{
+    return !incrementalSelection.isNull() && selectionSeed == QPoint(x, y) && selectionImage == image;
+}
+
+/**
+ * @brief Gets the color distance of a pixel to the clicked color, as compared with the threshold.
+ *
+ * @param index Pixel index in selectionImage.
+ * @return int Largest channel difference, or MAX_LEVEL + 1 for removed (transparent) pixels.
+ */
+int MagicWand::seedDistance(int index) const
+{
+    const QRgb color = reinterpret_cast<const QRgb*>(selectionImage.constScanLine(index / selectionImage.width()))[index % selectionImage.width()];
+    if (color == Qt::transparent)
+        return MAX_LEVEL + 1;
+    return qMax(qAbs(originalColorRed - qRed(color)), qMax(qAbs(originalColorGreen - qGreen(color)), qAbs(originalColorBlue - qBlue(color))));
 }
 
 /**
@@ -91,62 +510,109 @@ bool MagicWand::colorWithinThreshold(QRgb colorToCheck)
 }
 
 /**
- * @brief Implementation of Forest Fire Algorithm for Magic Wand Implementation
+ * @brief Implementation of Forest Fire Algorithm for Magic Wand Implementation, as a scanline (span) flood fill
  *
- * @param img Original image to get new filter applied image.
+ * @param img Image to select from, it is not modified.
+ * @param selection Receives the selected pixels, it doubles as the visited set.
  * @param x Position of pixel from the top edge
  * @param y Position of pixel from the left edge
  *
  * Check if (x,y) pixel is within the image and within the color threshold
- * Set pixel to transparent and enqueue QPoint (x,y) into forestFireQueue
- * Recursively check the top, left, right, and down neighbouring pixels in the same way
+ * Pop a seed, extend it to the left and right as far as the pixels are within the threshold, select the whole run at once
+ * Scan the rows above and below the run and push one seed per run of unselected pixels within the threshold
  */
-void MagicWand::forestFire(QImage &img, int x, int y)
+void MagicWand::forestFire(const QImage &img, BitMask &selection, int x, int y)
 {
     // If pixel out of bound, return
     if (x < 0 || x >= img.width() || y < 0 || y >= img.height())
         return;
 
-    // If pixel is not within threshold, we do not need to edit the pixel, thus we return
+    // If pixel is not within threshold, it is not selected, thus we return
     if (!colorWithinThreshold(PixelHelper::getPixel(img, x, y)))
         return;
 
-    // Set the color of the current pixel to transparent
-    PixelHelper::setPixel(img, x, y, Qt::transparent);
+    QVector<Point> seeds;
+    seeds.append(Point(x, y));
+    while (!seeds.isEmpty()) {
+        Point seed = seeds.takeLast();
+        if (selection.testBit(seed.getX(), seed.getY()))
+            continue;
 
-    // Add node to the end of our queue
-    forestFireQueue.enqueue(Point(x, y));
+        // Extend the seed to the whole run within the threshold
+        const QRgb* line = reinterpret_cast<const QRgb*>(img.constScanLine(seed.getY()));
+        int left = seed.getX(), right = seed.getX();
+        while (left > 0 && !selection.testBit(left - 1, seed.getY()) && colorWithinThreshold(line[left - 1]))
+            --left;
+        while (right + 1 < img.width() && !selection.testBit(right + 1, seed.getY()) && colorWithinThreshold(line[right + 1]))
+            ++right;
+        selection.setSpan(seed.getY(), left, right);
 
-    Point n;
-    while (!forestFireQueue.empty()) {
-        n = forestFireQueue.dequeue();
-
-        // If the color of adjacent pixels is within the threshold,
-        // set the adjacent pixels to transparent, and add them to the end of the queue.
-        if (n.getX() + 1 < img.width()) {
-            if (colorWithinThreshold(PixelHelper::getPixel(img, n.getX() + 1, n.getY()))) {
-                PixelHelper::setPixel(img, n.getX() + 1, n.getY(), Qt::transparent);
-                forestFireQueue.enqueue(Point(n.getX() + 1, n.getY()));
+        // One seed per run of candidate pixels in the neighbouring rows
+        for (int neighbourY : {seed.getY() - 1, seed.getY() + 1}) {
+            if (neighbourY < 0 || neighbourY >= img.height())
+                continue;
+            const QRgb* neighbourLine = reinterpret_cast<const QRgb*>(img.constScanLine(neighbourY));
+            bool inRun = false;
+            for (int i = left; i <= right; ++i) {
+                bool candidate = !selection.testBit(i, neighbourY) && colorWithinThreshold(neighbourLine[i]);
+                if (candidate && !inRun)
+                    seeds.append(Point(i, neighbourY));
+                inRun = candidate;
             }
         }
-        if (n.getX() - 1 >= 0) {
-            if (colorWithinThreshold(PixelHelper::getPixel(img, n.getX() - 1, n.getY()))) {
-                PixelHelper::setPixel(img, n.getX() - 1, n.getY(), Qt::transparent);
-                forestFireQueue.enqueue(Point(n.getX() - 1, n.getY()));
-            }
+    }
+}
+
+/**
+ * @brief Forest fire over precomputed segments, selects the same pixels as forestFire().
+ * @details Segments are 4-connected, so when the fire reaches a segment whose whole color range is within the threshold,
+ * the segment is selected at once and the fire continues from its border pixels only.
+ * Pixels of the other segments are visited one by one.
+ *
+ * @param img Image to select from, the index must be built from it.
+ * @param index Segments of img.
+ * @param selection Mask to set selected pixels in, with the size of img.
+ * @param x Position of pixel from the top edge
+ * @param y Position of pixel from the left edge
+ */
+void MagicWand::forestFireSegments(const QImage &img, const SuperpixelIndex &index, BitMask &selection, int x, int y)
+{
+    if (x < 0 || x >= img.width() || y < 0 || y >= img.height())
+        return;
+    if (!colorWithinThreshold(PixelHelper::getPixel(img, x, y)))
+        return;
+
+    const QRgb originalColor = qRgb(originalColorRed, originalColorGreen, originalColorBlue);
+    QVector<char> segmentTested(index.segmentCount(), 0);
+    QVector<char> segmentInside(index.segmentCount(), 0);
+    QVector<Point> pixels;
+    pixels.append(Point(x, y));
+
+    auto pushNeighbours = [&](int i, int j) {
+        if (i + 1 < img.width() && !selection.testBit(i + 1, j)) pixels.append(Point(i + 1, j));
+        if (i > 0 && !selection.testBit(i - 1, j)) pixels.append(Point(i - 1, j));
+        if (j + 1 < img.height() && !selection.testBit(i, j + 1)) pixels.append(Point(i, j + 1));
+        if (j > 0 && !selection.testBit(i, j - 1)) pixels.append(Point(i, j - 1));
+    };
+
+    while (!pixels.isEmpty()) {
+        const Point pixel = pixels.takeLast();
+        const int i = pixel.getX(), j = pixel.getY();
+        if (selection.testBit(i, j))
+            continue;
+        const int label = index.label(i, j);
+        if (!segmentTested[label]) {
+            segmentTested[label] = 1;
+            segmentInside[label] = index.isWithinThreshold(label, originalColor, threshold);
         }
-        if (n.getY() + 1 < img.height()) {
-            if (colorWithinThreshold(PixelHelper::getPixel(img, n.getX(), n.getY() + 1))) {
-                PixelHelper::setPixel(img, n.getX(), n.getY() + 1, Qt::transparent);
-                forestFireQueue.enqueue(Point(n.getX(), n.getY() + 1));
-            }
+        if (segmentInside[label]) {
+            // Whole segment, continue from its border
+            index.fillSegment(label, selection);
+            index.forEachBorderPixel(label, pushNeighbours);
         }
-        if (n.getY() - 1 >= 0) {
-            if (colorWithinThreshold(PixelHelper::getPixel(img, n.getX(), n.getY() - 1))) {
-                PixelHelper::setPixel(img, n.getX(), n.getY() - 1, Qt::transparent);
-                forestFireQueue.enqueue(Point(n.getX(), n.getY() - 1));
-            }
+        else if (colorWithinThreshold(reinterpret_cast<const QRgb*>(img.constScanLine(j))[i])) {
+            selection.setBit(i, j);
+            pushNeighbours(i, j);
         }
     }
-
 }
@@ -2,7 +2,12 @@
 #define MAGICWAND_H
 
 #include "../AbstractNonKernelBasedImageFilterTransform.h"
-#include <QQueue>
+#include "../../Utilities/BitMask.h"
+#include "../../Utilities/SuperpixelIndex.h"
+#include <QSharedPointer>
+#include <QVector>
+#include <QImage>
+#include <QPoint>
 
 class MagicWand: public AbstractNonKernelBasedImageFilterTransform
 {
@@ -16,8 +21,35 @@ public:
     virtual QImage applyFilter(const QImage &img) const override;
 
 public:
-    QImage crop(const QImage& img, int x, int y, int threshold);
-    void forestFire(QImage& img, int x, int y);
+/**
+ * @enum SelectionMode.
+ *
+ * @brief Which pixels a click selects.
+ */
+    enum class SelectionMode {
+        CONTIGUOUS,     //!< The 4-connected region around the click within threshold of the clicked color.
+        GLOBAL,         //!< Every pixel of the image within threshold of the clicked color.
+        COMPONENTS,     //!< The precomputed region of the click, neighbours within threshold of each other are connected.
+    };
+
+public:
+    QImage crop(const QImage& img, int x, int y, int threshold, SelectionMode mode = SelectionMode::CONTIGUOUS);
+    BitMask select(const QImage& img, int x, int y, int threshold);
+    BitMask selectGlobal(const QImage& img, int x, int y, int threshold);
+    BitMask selectComponent(const QImage& img, int x, int y, int threshold);
+    void forestFire(const QImage& img, BitMask& selection, int x, int y);
+    void forestFireSegments(const QImage& img, const SuperpixelIndex& index, BitMask& selection, int x, int y);
+    void setSuperpixelIndex(QSharedPointer<const SuperpixelIndex> index) { superpixelIndex = index; }  //!< Segments used by the selections for the image they were built from.
+    QSharedPointer<const SuperpixelIndex> getSuperpixelIndex() const { return superpixelIndex; }     //!< Segments set with setSuperpixelIndex(), may be null.
+
+    void beginSelection(const QImage& img, int x, int y);
+    const BitMask& updateSelection(int threshold);
+    const QVector<int>& selectionChanges() const { return changedPixels; }  //!< Pixels that joined or left the selection in the last updateSelection().
+    bool hasSelection(const QImage& img, int x, int y) const;
+
+    bool hasComponentIndex(const QImage& img) const;
+    void takeComponentIndex(MagicWand& other);
+    void releaseComponentIndex();
 
 private:
     /**
@@ -59,14 +91,42 @@ private:
     };
 
 private:
+    /**
+     * @brief Connected component labels of an image, reused by later clicks on the same image.
+     */
+    struct ComponentIndex {
+        qint64 key = 0;             //!< QImage::cacheKey() of the image version the labels belong to.
+        QSize size;                 //!< Size of that image version.
+        int threshold = -1;         //!< Threshold the labels were computed with.
+        QVector<int> labels;        //!< Per pixel, the smallest pixel index of its component, -1 for removed pixels.
+    };
+
     bool colorWithinThreshold(QRgb colorToCheck);
+    static QVector<int> labelComponents(const QImage& img, int threshold);
+    const ComponentIndex& componentIndexFor(const QImage& img, int threshold);
+
+    ComponentIndex componentIndex;          //!< Labels of the image last selected from in COMPONENTS mode.
+
+    int seedDistance(int index) const;
+
+    QSharedPointer<const SuperpixelIndex> superpixelIndex;     //!< Precomputed segments, may be null or belong to another image.
+
+    QImage selectionImage;                  //!< Image of the incremental selection, see beginSelection().
+    QPoint selectionSeed;                   //!< Clicked pixel of the incremental selection.
+    QSharedPointer<const SuperpixelIndex> selectionSegments;   //!< superpixelIndex if it was built from selectionImage, else null.
+    BitMask incrementalSelection;           //!< Pixels selected at the current threshold.
+    QVector<QVector<int>> frontier;         //!< Bucket queue, frontier[level] holds unselected pixels reachable at that threshold.
+    QVector<int> selectionOrder;            //!< Selected pixels in the order they joined, their levels never decrease.
+    QVector<uchar> selectionLevels;         //!< Threshold at which each pixel of selectionOrder joined.
+    QVector<int> changedPixels;             //!< Pixels that joined or left the selection in the last updateSelection().
+    static const int MAX_LEVEL = 255;       //!< Largest meaningful threshold, removed pixels are never reachable.
+    static const int ROWS_PER_BAND = 64;    //!< Rows processed by one task in the parallel selections.
 
 private:
     int originalColorRed;
     int originalColorGreen;
     int originalColorBlue;
     int threshold;
-    QQueue<Point> forestFireQueue;
 };
 
 #endif // MAGICWAND_H
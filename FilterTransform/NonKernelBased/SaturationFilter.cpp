@@ -3,6 +3,7 @@
  * @brief Saturation Filter Non-Kernel Implementation.
  */
 #include "SaturationFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Saturation Filter:: Saturation Filter object
@@ -30,33 +31,50 @@ QString SaturationFilter::getName() const
  * @param image Original image to get new filter applied image.
  * @param strength Strength of Saturation level to be applied
  *
- * Get qRgb of each pixel with PixelHelper::getPixel
+ * For each pixel, applyToPixel() does the following:
  * Convert qRgb into QColor format
  * Change the Saturation Value for each pixel and set with setHsv
- * Use the value to set the new image with PixelHelper::setPixel
  *
  * @return QImage Filter applied image.
  */
 QImage SaturationFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
     // This filter will be dealing with integer strength values
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
+    }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The saturation filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool SaturationFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the saturation filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the saturation to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb SaturationFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
     }
     // 1. we turn from rgb to saturation
     // 2. simple hsv filter, adds the strength directly to the saturation value, but with upper and lower bounds
     // 3. we turn saturation back to rgb
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            QColor pixelColor = QColor::fromRgb(pixel);
-            int hsvSaturation = qBound(0, pixelColor.hsvSaturation() + static_cast<int>(strength), 255);
-            pixelColor.setHsv(pixelColor.hsvHue(), hsvSaturation, pixelColor.value());
-            PixelHelper::setPixel(newImage, i, j, pixelColor.rgba());
-        }
-    }
-    return newImage;
+    QColor pixelColor = QColor::fromRgb(pixel);
+    int hsvSaturation = qBound(0, pixelColor.hsvSaturation() + static_cast<int>(strength), 255);
+    pixelColor.setHsv(pixelColor.hsvHue(), hsvSaturation, pixelColor.value());
+    return pixelColor.rgba();
 }
 
 /**
@@ -69,3 +87,25 @@ QImage SaturationFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the saturation filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void SaturationFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Adds the strength to the hsv saturation, bounded to 0..1
+    const float shift = static_cast<int>(strength) / 255.0f;
+    for (int i = 0; i < count; ++i) {
+        float* pixel = rgba + i * FloatImage::CHANNELS;
+        float hue, saturation, value;
+        FloatImage::toHsv(pixel, hue, saturation, value);
+        FloatImage::fromHsv(hue, qBound(0.0f, saturation + shift, 1.0f), value, pixel);
+    }
+}
@@ -3,6 +3,7 @@
  * @brief Saturation Filter Non-Kernel Implementation.
  */
 #include "TemperatureFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Temperature Filter:: Temperature Filter object
@@ -30,31 +31,58 @@ QString TemperatureFilter::getName() const
  * @param image Original image to get new filter applied image.
  * @param strength Strength of Saturation level to be applied
  *
- * Get qRgb of each pixel with PixelHelper::getPixel
+ * For each pixel, applyToPixel() does the following:
  * Increase the R value with the strength value
  * Keep the G value
  * Decrease the B value with the strength value
- * Use the value to set the new image with PixelHelper::setPixel
  *
  * @return QImage Filter applied image.
  */
 QImage TemperatureFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
     // This filter will be dealing with integer strength values
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
     }
-    // Add integer strength to red and blue
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            int newRed = qBound(0, qRed(pixel) + static_cast<int>(strength), 255);
-            int newBlue = qBound(0, qBlue(pixel) - static_cast<int>(strength), 255);
-            PixelHelper::setPixel(newImage, i, j, qRgb(newRed, qGreen(pixel), newBlue));
-        }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The temperature filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool TemperatureFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief The temperature filter shifts red and blue on their own.
+ *
+ * @return true Always.
+ */
+bool TemperatureFilter::isChannelSeparable() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the temperature filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the temperature to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb TemperatureFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
     }
-    return newImage;
+    // Add integer strength to red and blue
+    int newRed = qBound(0, qRed(pixel) + static_cast<int>(strength), 255);
+    int newBlue = qBound(0, qBlue(pixel) - static_cast<int>(strength), 255);
+    return qRgb(newRed, qGreen(pixel), newBlue);
 }
 
 /**
@@ -67,3 +95,22 @@ QImage TemperatureFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the temperature filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void TemperatureFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Add integer strength to red and subtract it from blue
+    const float shift = static_cast<int>(strength) / 255.0f;
+    const float scale[FloatImage::CHANNELS] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const float offset[FloatImage::CHANNELS] = {shift, 0.0f, -shift, 0.0f};
+    FloatImage::applyAffine(rgba, count, scale, offset);
+}
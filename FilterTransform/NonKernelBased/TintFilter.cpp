@@ -3,6 +3,7 @@
  * @brief Tint Filter Non-Kernel Implementation.
  */
 #include "TintFilter.h"
+#include "../../Utilities/FloatImage.h"
 
 /**
  * @brief Construct a new Tint Filter:: Tint Filter object
@@ -30,30 +31,57 @@ QString TintFilter::getName() const
  * @param image Original image to get new filter applied image.
  * @param strength Strength of Saturation level to be applied
  *
- * Get qRgb of each pixel with PixelHelper::getPixel
+ * For each pixel, applyToPixel() does the following:
  * Keep the R value
  * Increase the G value with the strength value
  * Keep the B value
- * Use the value to set the new image with PixelHelper::setPixel
  *
  * @return QImage Filter applied image.
  */
 QImage TintFilter::applyFilter(const QImage &image, double strength) const
 {
-    QImage newImage{image};
     // This filter will be dealing with integer strength values
     if (static_cast<int>(strength) == 0) {
-        return newImage;
+        return QImage{image};
     }
-    // Add integer strength to green
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb pixel = PixelHelper::getPixel(image, i, j);
-            int newGreen = qBound(0, qGreen(pixel) + static_cast<int>(strength), 255);
-            PixelHelper::setPixel(newImage, i, j, qRgb(qRed(pixel), newGreen, qBlue(pixel)));
-        }
+    return applyPointOperation(image, strength);
+}
+
+/**
+ * @brief The tint filter is a point operation.
+ *
+ * @return true Always.
+ */
+bool TintFilter::isPointOperation() const
+{
+    return true;
+}
+
+/**
+ * @brief The tint filter shifts green on its own.
+ *
+ * @return true Always.
+ */
+bool TintFilter::isChannelSeparable() const
+{
+    return true;
+}
+
+/**
+ * @brief Applies the tint filter to a single pixel.
+ *
+ * @param pixel Original pixel.
+ * @param strength Strength of the tint to be applied
+ * @return QRgb Filter applied pixel.
+ */
+QRgb TintFilter::applyToPixel(QRgb pixel, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return pixel;
     }
-    return newImage;
+    // Add integer strength to green
+    int newGreen = qBound(0, qGreen(pixel) + static_cast<int>(strength), 255);
+    return qRgb(qRed(pixel), newGreen, qBlue(pixel));
 }
 
 /**
@@ -66,3 +94,22 @@ QImage TintFilter::applyFilter(const QImage &image) const
     QImage newImage{image};
     return newImage;
 }
+
+/**
+ * @brief Applies the tint filter to high precision pixels, see FloatImage.
+ *
+ * @param rgba Interleaved RGBA pixels, modified in place.
+ * @param count Number of pixels.
+ * @param strength Strength of the filter/transform.
+ */
+void TintFilter::applyToFloatPixels(float *rgba, int count, double strength) const
+{
+    if (static_cast<int>(strength) == 0) {
+        return;
+    }
+    // Add integer strength to green
+    const float shift = static_cast<int>(strength) / 255.0f;
+    const float scale[FloatImage::CHANNELS] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const float offset[FloatImage::CHANNELS] = {0.0f, shift, 0.0f, 0.0f};
+    FloatImage::applyAffine(rgba, count, scale, offset);
+}
@@ -0,0 +1,151 @@
+/**
+ * @class OperationGraph
+ * @brief Records filter/transform applications and evaluates them lazily.
+ * @details Operations are appended as nodes and are not run until evaluate() is called, i.e. when the pixels are needed.
+ * Adjacent point operations (see AbstractNonKernelBasedImageFilterTransform::isPointOperation()) are fused:
+ * each pixel is read once, passed through every fused applyToPixel() in order, and written once.
+ * Fused runs are evaluated in place, row bands in parallel. Other operations get the whole image.
+ * The result is identical to applying the operations one after another.
+ */
+
+#include "OperationGraph.h"
+#include "../Utilities/ImageBufferPool.h"
+
+#include <QtConcurrent>
+
+/**
+ * @brief Destroy the Operation Graph:: Operation Graph object, and the recorded filters.
+ */
+OperationGraph::~OperationGraph()
+{
+    clear();
+}
+
+/**
+ * @brief Records an operation. The graph takes ownership of filterTransform.
+ *
+ * @param filterTransform Filter/transform to apply.
+ * @param size Filter kernel size (if any).
+ * @param strength Filter strength (if any).
+ */
+void OperationGraph::append(AbstractImageFilterTransform* filterTransform, int size, double strength)
+{
+    const AbstractNonKernelBasedImageFilterTransform* pointOperation = qobject_cast<AbstractNonKernelBasedImageFilterTransform*>(filterTransform);
+    if (pointOperation && !pointOperation->isPointOperation()) {
+        pointOperation = nullptr;
+    }
+    nodes.append(Node{filterTransform, pointOperation, size, strength});
+}
+
+/**
+ * @brief Removes and deletes every recorded operation.
+ */
+void OperationGraph::clear()
+{
+    for (const Node& node : nodes) {
+        delete node.filterTransform;
+    }
+    nodes.clear();
+}
+
+/**
+ * @brief Names of the recorded operations, oldest first.
+ *
+ * @return QStringList Filter names.
+ */
+QStringList OperationGraph::names() const
+{
+    QStringList result;
+    for (const Node& node : nodes) {
+        result.append(node.filterTransform->getName());
+    }
+    return result;
+}
+
+/**
+ * @brief Evaluates the recorded operations on image.
+ * @details image is not modified. Its pixels are copied once, on the first point operation, and every later run writes to that copy.
+ *
+ * @param image Image to evaluate the operations on.
+ * @return QImage Image after every recorded operation.
+ */
+QImage OperationGraph::evaluate(const QImage& image) const
+{
+    QImage result = image;
+    int i = 0;
+    while (i < nodes.size()) {
+        if (nodes[i].pointOperation) {
+            // Fuse the whole run of adjacent point operations into one pass.
+            int end = i;
+            while (end < nodes.size() && nodes[end].pointOperation) {
+                ++end;
+            }
+            applyFusedPointOperations(result, nodes.mid(i, end - i));
+            i = end;
+        }
+        else {
+            // Neighbourhood or geometric operations need the whole image.
+            const Node& node = nodes[i];
+            QImage whole = node.filterTransform->applyFilter(result, node.size, node.strength);
+            ImageBufferPool::release(result);
+            result = whole;
+            ++i;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Evaluates the recorded operations on a high precision image, in place.
+ * @details Point operations run through applyToFloatPixels(), row bands in parallel, without quantising in between.
+ * Other operations only exist for 8-bit images, so the image is quantised for them and dequantised afterwards.
+ *
+ * @param image Image to evaluate the operations on.
+ */
+void OperationGraph::evaluate(FloatImage& image) const
+{
+    for (const Node& node : nodes) {
+        if (node.pointOperation) {
+            image.mapRows([&node](float* line, int count) {
+                node.pointOperation->applyToFloatPixels(line, count, node.strength);
+            });
+        }
+        else {
+            QImage input = image.toImage();
+            image = FloatImage(node.filterTransform->applyFilter(input, node.size, node.strength));
+            ImageBufferPool::release(input);
+        }
+    }
+}
+
+/**
+ * @brief Passes every pixel of image through all fused point operations.
+ *
+ * @param image Image to modify in place, row bands are processed in parallel.
+ * @param fused Point operations, oldest first.
+ */
+void OperationGraph::applyFusedPointOperations(QImage& image, const QVector<Node>& fused)
+{
+    const int height = image.height();
+    const int width = image.width();
+    QVector<int> bands((height + ROWS_PER_BAND - 1) / ROWS_PER_BAND);
+    for (int i = 0; i < bands.size(); ++i) {
+        bands[i] = i * ROWS_PER_BAND;
+    }
+    // Detach once here, worker threads must not race to detach pixels shared with a copy
+    uchar* bits = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+    QtConcurrent::blockingMap(bands, [bits, bytesPerLine, width, height, &fused](int firstRow) {
+        int lastRow = qMin(firstRow + static_cast<int>(ROWS_PER_BAND), height);
+        for (int j = firstRow; j < lastRow; ++j) {
+            QRgb* line = reinterpret_cast<QRgb*>(bits + j * bytesPerLine);
+            for (int i = 0; i < width; ++i) {
+                QRgb pixel = line[i];
+                for (const Node& node : fused) {
+                    pixel = node.pointOperation->applyToPixel(pixel, node.strength);
+                }
+                line[i] = pixel;
+            }
+        }
+    });
+}
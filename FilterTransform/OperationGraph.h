@@ -0,0 +1,47 @@
+#ifndef OPERATIONGRAPH_H
+#define OPERATIONGRAPH_H
+
+#include <QImage>
+#include <QVector>
+#include <QStringList>
+
+#include "AbstractNonKernelBasedImageFilterTransform.h"
+#include "../Utilities/FloatImage.h"
+
+class OperationGraph
+{
+public:
+    /**
+     * @brief A recorded filter/transform application.
+     */
+    struct Node {
+        AbstractImageFilterTransform*                       filterTransform;    //!< Owned filter/transform.
+        const AbstractNonKernelBasedImageFilterTransform*   pointOperation;     //!< Same object if it is a point operation, else nullptr.
+        int                                                 size;               //!< Kernel size passed to applyFilter().
+        double                                              strength;           //!< Strength passed to applyFilter().
+    };
+
+public:
+    OperationGraph() = default;
+    OperationGraph(const OperationGraph&) = delete;
+    OperationGraph& operator=(const OperationGraph&) = delete;
+    ~OperationGraph();
+
+    void                        append(AbstractImageFilterTransform* filterTransform, int size, double strength);
+    void                        clear();
+    bool                        isEmpty() const { return nodes.isEmpty(); }         //!< True if no operation is recorded.
+    const QVector<Node>&        getNodes() const { return nodes; }                  //!< Recorded operations, oldest first.
+    QStringList                 names() const;
+
+    QImage                      evaluate(const QImage& image) const;
+    void                        evaluate(FloatImage& image) const;
+
+private:
+    static void                 applyFusedPointOperations(QImage& image, const QVector<Node>& fused);
+
+private:
+    QVector<Node>               nodes;      //!< Recorded operations, oldest first.
+    static const int            ROWS_PER_BAND = 64;     //!< Rows a worker thread processes at a time in a fused run.
+};
+
+#endif // OPERATIONGRAPH_H
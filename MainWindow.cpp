@@ -43,6 +43,8 @@
 #include "FilterTransform/NonKernelBased/BrightnessFilter.h"
 #include "FilterTransform/NonKernelBased/ContrastFilter.h"
 #include "FilterTransform/NonKernelBased/ExposureFilter.h"
+#include "FilterTransform/NonKernelBased/AutoLevelsFilter.h"
+#include "FilterTransform/NonKernelBased/ClaheFilter.h"
 
 #include "FilterTransform/NonKernelBased/ClockwiseRotationTransform.h"
 #include "FilterTransform/NonKernelBased/CounterClockwiseRotationTransform.h"
@@ -55,8 +57,10 @@
 #include "FilterTransform/KernelBased/EdgeDetectionFilter.h"
 #include "FilterTransform/KernelBased/ImageInpainting.h"
 #include "FilterTransform/KernelBased/ImageScissors.h"
+#include "FilterTransform/NonKernelBased/FastMarchingInpainting.h"
 
 #include "ServerRoom.h"
+#include "Utilities/ImageBufferPool.h"
 
 /**
  * @brief Construct a new Main Window::MainWindow object.
@@ -68,6 +72,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent),
 {
     ui->setupUi(this);
 
+    // Pooled image buffers are only reused while filters are being applied
+    bufferPoolTimer.setSingleShot(true);
+    bufferPoolTimer.setInterval(BUFFER_POOL_IDLE_MSEC);
+    connect(&bufferPoolTimer, &QTimer::timeout, this, []() { ImageBufferPool::clear(); });
+
     /*
      * Adds a toolbar on runtime, layed out vertically, aligned to the right
      */
@@ -353,6 +362,31 @@ void MainWindow::createActions()
     clearScreenAct = new QAction(tr("&Clear Screen"), this);
     clearScreenAct->setShortcut(tr("Ctrl+L"));
     connect(clearScreenAct, SIGNAL(triggered()), this, SLOT(on_actionNew_triggered()));
+
+    // Create high precision action, point operations are then chained in float and only quantised for display.
+    // It has no effect while connected to a server, where every client has to evaluate the same 8-bit chain.
+    highPrecisionAct = new QAction(tr("&High Precision Editing"), this);
+    highPrecisionAct->setCheckable(true);
+    connect(highPrecisionAct, &QAction::toggled, this, [this](bool) {
+        highPrecisionImage = FloatImage();
+        highPrecisionOutput = QImage();
+    });
+
+    // Create superpixel action, the image is then segmented in the background when the magic wand is picked, to speed up its selections
+    superpixelAct = new QAction(tr("&Precompute Selection Segments"), this);
+    superpixelAct->setCheckable(true);
+    connect(superpixelAct, &QAction::toggled, this, [this](bool checked) {
+        if (!checked)
+            workspaceArea->clearSuperpixelIndex();
+    });
+
+    // Create sampled histogram action, large images then show an estimated histogram while the exact one is counted in the background
+    sampledHistogramAct = new QAction(tr("&Sampled Histogram Preview"), this);
+    sampledHistogramAct->setCheckable(true);
+    sampledHistogramAct->setChecked(true);
+    connect(sampledHistogramAct, &QAction::toggled, this, [this](bool checked) {
+        histo->setSamplingEnabled(checked);
+    });
 }
 
 /**
@@ -411,7 +445,7 @@ void MainWindow::checkoutCommit(int masterNodeNumber, int sideNodeNumber, bool f
     // 2. Go through images in the side branch
     QLinkedList<VersionControl::SideNode>::iterator it2 = it->sideBranch.begin();
     it2 += sideNodeNumber;
-    rerenderWorkspaceArea(it2->currentImage, it2->currentImage.width(), it2->currentImage.height());
+    rerenderWorkspaceArea(it2->currentImage(), it2->currentTiles.width(), it2->currentTiles.height());
     if (fromActionMenu) {
         sendVersion("checkoutCommit", masterNodeNumber, sideNodeNumber);
     }
@@ -448,6 +482,9 @@ void MainWindow::createMenus()
     // Attach all actions to Options
     optionMenu = new QMenu(tr("&Options"), this);
     optionMenu->addAction(clearScreenAct);
+    optionMenu->addAction(highPrecisionAct);
+    optionMenu->addAction(superpixelAct);
+    optionMenu->addAction(sampledHistogramAct);
 
     menuBar()->addMenu(optionMenu);
 }
@@ -564,6 +601,7 @@ void MainWindow::on_actionOpen_triggered()
             {
                 return;
             }
+            loadedImage = PixelHelper::toWorkingFormat(loadedImage);
             this->fileName = fileName;
             fileSaved = false;
 
@@ -582,7 +620,8 @@ void MainWindow::on_actionOpen_triggered()
             resizedImageHeight = imageHeight;
             basics->setImageDimensions(imageWidth, imageHeight);
 
-            // Setup our workspace
+            // Setup our workspace, buffers pooled for the previous image are of no use
+            ImageBufferPool::clear();
             workspaceArea->openImage(loadedImage, imageWidth, imageHeight);
             resizeGraphicsViewBoundaries(imageWidth, imageHeight);
             fitImageToScreen(imageWidth, imageHeight);
@@ -752,11 +791,13 @@ void MainWindow::on_actionAbout_Us_triggered()
 /**
  * @brief Updates image on image drawn/scribbled.
  * 
- * @details commits changes to version control.
+ * @details commits changes to version control, and updates the histogram for the stroke region only.
+ * @param region Region covered by the stroke.
  */
-void MainWindow::onImageDrawn()
+void MainWindow::onImageDrawn(const QRect &region)
 {
     QImage image = workspaceArea->commitImage();
+    histo->onRegionChanged(image, region);
     commitChanges(image, "Brush");
 }
 
@@ -890,8 +931,9 @@ void MainWindow::onZoom(const QString &level)
  * 
  * @param cursor a WorkspaceArea::CursorMode cursor.
  * @param data Any integer data that is needed for certain cursor, e.g. Magic Wand threshold.
+ * @param option Any additional option that is needed for certain cursor, e.g. Magic Wand selection mode.
  */
-void MainWindow::onCrossCursorChanged(WorkspaceArea::CursorMode cursor, int data)
+void MainWindow::onCrossCursorChanged(WorkspaceArea::CursorMode cursor, int data, int option)
 {
     graphicsView->setCursor(Qt::CrossCursor);
     switch (cursor)
@@ -902,6 +944,10 @@ void MainWindow::onCrossCursorChanged(WorkspaceArea::CursorMode cursor, int data
     case WorkspaceArea::CursorMode::MAGICWAND:
         workspaceArea->setCursorMode(WorkspaceArea::CursorMode::MAGICWAND);
         workspaceArea->setMagicWandThreshold(data);
+        workspaceArea->setMagicWandMode(static_cast<MagicWand::SelectionMode>(option));
+        // Segmented on first use only, edits that never touch the magic wand pay nothing
+        if (superpixelAct->isChecked() && workspaceArea->getImageLoaded())
+            workspaceArea->buildSuperpixelIndex();
         break;
     case WorkspaceArea::CursorMode::SCRIBBLE:
         graphicsView->setCursor(Qt::ArrowCursor);
@@ -973,6 +1019,7 @@ void MainWindow::rerenderWorkspaceArea(const QImage &image, int imageWidth, int
 
     // Create a new workspaceArea to hold the newly cropped image, while setting up all the connections needed.
     workspaceArea = new WorkspaceArea(imageWidth, imageHeight);
+    workspaceArea->takeCachesFrom(*temporaryArea);
     reconnectConnection();
 
     // Contain the new workspaceArea into our graphicsView
@@ -987,6 +1034,7 @@ void MainWindow::rerenderWorkspaceArea(const QImage &image, int imageWidth, int
 
     // Actually open the cropped image
     workspaceArea->openImage(image, imageWidth, imageHeight);
+    bufferPoolTimer.start();
     resizeGraphicsViewBoundaries(imageWidth, imageHeight);
     fitImageToScreen(imageWidth, imageHeight);
 
@@ -1027,6 +1075,26 @@ void MainWindow::resetGraphicsViewScale()
  */
 void MainWindow::applyFilterTransform(AbstractImageFilterTransform *filterTransform, int size, double strength, bool fromServer)
 {
+    // Point operations are only recorded, consecutive ones are fused and evaluated together once control returns to the event loop.
+    AbstractNonKernelBasedImageFilterTransform *pointOperation = qobject_cast<AbstractNonKernelBasedImageFilterTransform *>(filterTransform);
+    if (pointOperation && pointOperation->isPointOperation())
+    {
+        if (!pendingOperations.isEmpty() && pendingOperationsFromServer != fromServer)
+        {
+            evaluatePendingOperations();
+        }
+        if (pendingOperations.isEmpty())
+        {
+            QTimer::singleShot(0, this, &MainWindow::evaluatePendingOperations);
+        }
+        pendingOperationsFromServer = fromServer;
+        pendingOperations.append(filterTransform, size, strength);
+        return;
+    }
+
+    // This transform needs the pixels now, evaluate recorded operations first.
+    evaluatePendingOperations();
+
     // Commit all brush strokes before applying transform
     workspaceArea->commitImageAndSet();
 
@@ -1040,10 +1108,17 @@ void MainWindow::applyFilterTransform(AbstractImageFilterTransform *filterTransf
         } else if (filterTransform->getName() == "Image Inpainting") {
             ImageInpainting* temp = reinterpret_cast<ImageInpainting*>(filterTransform);
             sendFilterWithMask(filterTransform->getName(), size, strength, temp->getMask());
+        } else if (filterTransform->getName() == "Fast Marching Inpainting") {
+            FastMarchingInpainting* temp = reinterpret_cast<FastMarchingInpainting*>(filterTransform);
+            sendFilterWithMask(filterTransform->getName(), size, strength, temp->getMask());
         } else {
             sendFilter(filterTransform->getName(), size, strength);
         }
     }
+    if (filterTransform->getName() == "Image Inpainting") {
+        ImageInpainting* temp = reinterpret_cast<ImageInpainting*>(filterTransform);
+        ui->statusBar->showMessage(tr("Inpainting finished after %1 iterations").arg(temp->getIterationCount()), 5000);
+    }
     rerenderWorkspaceArea(result, result.width(), result.height());
 
     // Add after-filter-applied image to our image history version control, generate our history menu
@@ -1052,6 +1127,59 @@ void MainWindow::applyFilterTransform(AbstractImageFilterTransform *filterTransf
     delete filterTransform;
 }
 
+/**
+ * @brief Evaluates the recorded point operations on the current workspaceArea.
+ * @details All recorded operations are fused into one pass, sent to the server as one chain,
+ * and committed to the image history as one commit.
+ */
+void MainWindow::evaluatePendingOperations()
+{
+    if (pendingOperations.isEmpty())
+    {
+        return;
+    }
+
+    // Commit all brush strokes before applying the operations
+    workspaceArea->commitImageAndSet();
+
+    const QImage before = workspaceArea->getImage();
+    QImage result;
+    // Peers replay the chain in 8 bits, so while connected the chain is evaluated in 8 bits here too and every client gets the same pixels
+    if (highPrecisionAct->isChecked() && !isConnected)
+    {
+        // Keep working on the float buffer while the workspaceArea still shows its last output, i.e. nothing else changed the image.
+        const QImage &current = workspaceArea->getImage();
+        if (highPrecisionImage.isNull() || (current.cacheKey() != highPrecisionOutput.cacheKey() && current != highPrecisionOutput))
+        {
+            highPrecisionImage = FloatImage(current);
+        }
+        pendingOperations.evaluate(highPrecisionImage);
+        result = highPrecisionImage.toImage();
+        highPrecisionOutput = result;
+        // No look-up tables describe the float chain, the histogram is counted again
+        histo->drawHistogram(result);
+    }
+    else
+    {
+        highPrecisionImage = FloatImage();
+        highPrecisionOutput = QImage();
+        result = pendingOperations.evaluate(workspaceArea->getImage());
+        // The 8-bit result is what look-up tables give, so the histogram can be remapped instead of recounted
+        histo->onPointOperationsApplied(before, result, pendingOperations);
+    }
+    if (!pendingOperationsFromServer)
+    {
+        sendFilterChain(pendingOperations);
+    }
+    QString changes = pendingOperations.names().join(" + ");
+    pendingOperations.clear();
+
+    rerenderWorkspaceArea(result, result.width(), result.height());
+
+    // Add after-filter-applied image to our image history version control, generate our history menu
+    commitChanges(workspaceArea->getImage(), changes);
+}
+
 /**
  * @brief Updates our image previewer in color controls with this filter/transform.
  * 
@@ -1061,9 +1189,18 @@ void MainWindow::applyFilterTransform(AbstractImageFilterTransform *filterTransf
  */
 void MainWindow::applyFilterTransformOnPreview(AbstractImageFilterTransform *filterTransform, int size, double strength)
 {
-    QImage &&previewImageNoFilter = workspaceArea->commitImageForPreview();
-    QImage &&result = filterTransform->applyFilter(previewImageNoFilter, size, strength);
-    colors->setImagePreview(result);
+    QImage previewImage = workspaceArea->commitImageForPreview();
+    // The preview image is only referenced here, so point operations can overwrite it instead of allocating a new one.
+    AbstractNonKernelBasedImageFilterTransform *pointOperation = qobject_cast<AbstractNonKernelBasedImageFilterTransform *>(filterTransform);
+    if (pointOperation && pointOperation->isPointOperation())
+    {
+        pointOperation->applyPointOperationInPlace(previewImage, strength);
+        colors->setImagePreview(previewImage);
+    }
+    else
+    {
+        colors->setImagePreview(filterTransform->applyFilter(previewImage, size, strength));
+    }
     delete filterTransform;
 }
 
@@ -1312,7 +1449,7 @@ void MainWindow::clientJsonReceived(const QJsonObject &json)
     else if (type == "initialImage")
     {
         QByteArray ba = QByteArray::fromBase64(json.value(QString("data")).toString().toLatin1());
-        QImage img = QImage::fromData(ba, "PNG");
+        QImage img = PixelHelper::toWorkingFormat(QImage::fromData(ba, "PNG"));
         if (img.isNull())
         {
             qDebug() << "image error";
@@ -1330,7 +1467,8 @@ void MainWindow::clientJsonReceived(const QJsonObject &json)
             resizedImageHeight = imageHeight;
             basics->setImageDimensions(imageWidth, imageHeight);
 
-            // Setup our workspace
+            // Setup our workspace, buffers pooled for the previous image are of no use
+            ImageBufferPool::clear();
             workspaceArea->openImage(img, imageWidth, imageHeight);
             resizeGraphicsViewBoundaries(imageWidth, imageHeight);
             fitImageToScreen(imageWidth, imageHeight);
@@ -1366,6 +1504,17 @@ void MainWindow::clientJsonReceived(const QJsonObject &json)
             handleFilterBroadcast(name, size, strength);
         }
     }
+    else if (type == "applyFilterChain")
+    {
+        QJsonValue data = json.value(QString("data"));
+        for (const QJsonValue& filter : data["filters"].toArray()) {
+            QString name = filter["name"].toString();
+            if (!name.isEmpty()) {
+                handleFilterBroadcast(name, filter["size"].toInt(), filter["strength"].toDouble());
+            }
+        }
+        evaluatePendingOperations();
+    }
     else if (type == "applyFilterWithMask")
     {
         QJsonValue data = json.value(QString("data"));
@@ -1373,7 +1522,7 @@ void MainWindow::clientJsonReceived(const QJsonObject &json)
         int size = data["size"].toInt();
         double strength = data["strength"].toDouble();
         QByteArray ba = QByteArray::fromBase64(data["mask"].toString().toLatin1());
-        QImage mask = QImage::fromData(ba, "PNG");
+        QImage mask = PixelHelper::toWorkingFormat(QImage::fromData(ba, "PNG"));
         if (!mask.isNull() && !name.isEmpty()) {
             handleFilterBroadcast(name, size, strength, mask);
         }
@@ -1399,7 +1548,12 @@ void MainWindow::clientJsonReceived(const QJsonObject &json)
         QJsonValue data = json.value(QString("data"));
         int x = data["x"].toInt();
         int y = data["y"].toInt();
-        workspaceArea->cropImageWithMagicWand(x, y, true);
+        // The peer's threshold and mode apply to this crop only, the local tool settings are kept
+        if (data.toObject().contains("threshold")) {
+            workspaceArea->cropImageWithMagicWand(x, y, data["threshold"].toInt(), static_cast<MagicWand::SelectionMode>(data["mode"].toInt()), true);
+        } else {
+            workspaceArea->cropImageWithMagicWand(x, y, true);
+        }
     } else if (type == "versionControl") {
         QString action = json.value(QString("action")).toString();
         if (action == "checkoutCommit") {
@@ -1588,6 +1742,32 @@ void MainWindow::sendFilterWithMask(const QString& filterName, int size, double
     client->sendJson(json);
 }
 
+/**
+ * @brief Sends json to server for a chain of fused filters
+ * @param graph recorded operations, in the order they were applied
+ *
+ * @details Receivers apply the whole chain at once, so every client fuses the same operations and creates the same commit
+ */
+void MainWindow::sendFilterChain(const OperationGraph& graph) {
+    if (!isConnected || client == nullptr) {
+        return;
+    }
+    QJsonArray filters;
+    for (const OperationGraph::Node& node : graph.getNodes()) {
+        QJsonObject filter;
+        filter["name"] = node.filterTransform->getName();
+        filter["size"] = node.size;
+        filter["strength"] = node.strength;
+        filters.append(filter);
+    }
+    QJsonObject json;
+    QJsonObject data;
+    data["filters"] = filters;
+    json["type"] = "applyFilterChain";
+    json["data"] = data;
+    client->sendJson(json);
+}
+
 /**
  * @brief Sends json to server for version control
  * @param type type to set json's action
@@ -1683,15 +1863,19 @@ void MainWindow::onSendCrop(int x, int y, int width, int height) {
  * @brief Sends json to server for cropping with Magic Wand
  * @param x Position from top edge of screen
  * @param y Position from left edge of screen
+ * @param threshold Magic Wand tolerance used
+ * @param mode Magic Wand selection mode used
  *
- * @details If user is connected, send the x and y, applyCropWithMagicWand data.
+ * @details If user is connected, send the x and y, threshold and mode, applyCropWithMagicWand data.
  */
-void MainWindow::onSendCropWithMagicWand(int x, int y) {
+void MainWindow::onSendCropWithMagicWand(int x, int y, int threshold, int mode) {
     if (isConnected) {
         QJsonObject json;
         QJsonObject data;
         data["x"] = x;
         data["y"] = y;
+        data["threshold"] = threshold;
+        data["mode"] = mode;
         json["type"] = "applyCropWithMagicWand";
         json["data"] = data;
         client->sendJson(json);
@@ -1763,10 +1947,19 @@ void MainWindow::handleFilterBroadcast(const QString& name, int size, double str
     } else if (name == "Exposure Filter") {
         ExposureFilter *exposureFilter = new ExposureFilter();
         applyFilterTransform(exposureFilter, size, strength, true);
+    } else if (name == "Auto Levels") {
+        AutoLevelsFilter *autoLevelsFilter = new AutoLevelsFilter(AutoLevelsFilter::LEVELS);
+        applyFilterTransform(autoLevelsFilter, size, strength, true);
+    } else if (name == "Auto Contrast") {
+        AutoLevelsFilter *autoContrastFilter = new AutoLevelsFilter(AutoLevelsFilter::CONTRAST);
+        applyFilterTransform(autoContrastFilter, size, strength, true);
+    } else if (name == "CLAHE Filter") {
+        ClaheFilter *claheFilter = new ClaheFilter(size);
+        applyFilterTransform(claheFilter, size, strength, true);
     } else if (name == "Invert Filter") {
         InvertFilter *invertFilter = new InvertFilter();
         applyFilterTransform(invertFilter, size, strength, true);
-    } else if (name == "Exposure Filter") {
+    } else if (name == "Grayscale Filter") {
         GrayscaleFilter *grayscaleFilter = new GrayscaleFilter();
         applyFilterTransform(grayscaleFilter, size, strength, true);
     } else if (name == "Edge Detection Filter") {
@@ -1797,7 +1990,7 @@ void MainWindow::handleFilterBroadcast(const QString& name, int size, double str
 }
 
 /**
- * @brief Handling filter broadcast which needs mask (Image Scissors and Image Inpainting)
+ * @brief Handling filter broadcast which needs mask (Image Scissors, Image Inpainting and Fast Marching Inpainting)
  * @details applyFilterTransform according to the name of filter applied
  * and according to size and strength, also mask
  * @param name name of filter
@@ -1814,6 +2007,10 @@ void MainWindow::handleFilterBroadcast(const QString& name, int size, double str
         ImageInpainting *imageInpainting = new ImageInpainting(size);
         imageInpainting->setMask(mask);
         applyFilterTransform(imageInpainting, size, strength, true);
+    } else if (name == "Fast Marching Inpainting") {
+        FastMarchingInpainting *fastMarchingInpainting = new FastMarchingInpainting(size);
+        fastMarchingInpainting->setMask(mask);
+        applyFilterTransform(fastMarchingInpainting, size, strength, true);
     }
 }
 
@@ -11,6 +11,7 @@
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QVector>
+#include <QTimer>
 
 #include "Utilities/WindowHelper.h"
 #include "Utilities/VersionControl.h"
@@ -19,6 +20,7 @@
 #include "WorkspaceArea.h"
 
 #include "FilterTransform/AbstractImageFilterTransform.h"
+#include "FilterTransform/OperationGraph.h"
 #include "Palette/Histogram.h"
 #include "Palette/Brush.h"
 #include "Palette/ColorControls.h"
@@ -60,13 +62,14 @@ private slots:
 
     // Saving, workspace related slots.
     void                        saveAs();
-    void                        onImageDrawn();
+    void                        onImageDrawn(const QRect& region);
     void                        clearImage();
     void                        onZoom(const QString&);
-    void                        onCrossCursorChanged(WorkspaceArea::CursorMode, int data);
+    void                        onCrossCursorChanged(WorkspaceArea::CursorMode, int data, int option);
     void                        rerenderWorkspaceArea(const QImage&, int width, int height);
     void                        applyFilterTransform(AbstractImageFilterTransform* filterTransform, int size, double strength, bool fromServer = false);
     void                        applyFilterTransformOnPreview(AbstractImageFilterTransform* filterTransform, int size, double strength);
+    void                        evaluatePendingOperations();
     void                        onUpdateImagePreview();
 
     // Server related slots.
@@ -82,7 +85,7 @@ private slots:
     void                        onDisconnect();
     void                        onSendResize(int, int);
     void                        onSendCrop(int, int, int, int);
-    void                        onSendCropWithMagicWand(int, int);
+    void                        onSendCropWithMagicWand(int, int, int, int);
     void                        onSendMoveScribble(double, double, QString, int);
     void                        onSendReleaseScribble();
 
@@ -124,6 +127,7 @@ private:
     void                        destroyConnection();
     void                        sendFilter(const QString&, int, double);
     void                        sendFilterWithMask(const QString&, int, double, const QImage&);
+    void                        sendFilterChain(const OperationGraph&);
     void                        sendVersion(const QString&);
     void                        sendVersion(const QString&, int, int);
     void                        handleFilterBroadcast(const QString&, int, double);
@@ -144,10 +148,21 @@ private:
     QVector<QMenu*>             imageHistoryMenu;           //!< Stores the QMenus used for displaying the imageHistory.
     int                         masterNodeNumber = 0;       //!< Saves current checkout master node number (0: latest, 1: previous, etc).
     int                         sideNodeNumber = 0;         //!< Saves current checkout node number in a master node.
+    OperationGraph              pendingOperations;          //!< Point operations recorded but not yet evaluated.
+    bool                        pendingOperationsFromServer = false;    //!< The pending operations were received from the server.
 
     QMenu*                      optionMenu;                 //!< optionMenu is generated during runtime.
     QList<QAction*>             saveAsActs;                 //!< all possible image format that can be used to save the image.
     QAction*                    clearScreenAct;             //!< an action to clear the workspaceArea.
+    QAction*                    highPrecisionAct;           //!< a checkable action to keep point operations in a float buffer.
+    QAction*                    superpixelAct;              //!< a checkable action to segment opened images in the background for the magic wand.
+    QAction*                    sampledHistogramAct;        //!< a checkable action to show a sampled histogram of large images until the exact one is counted.
+
+    FloatImage                  highPrecisionImage;         //!< High precision image the point operations are evaluated on, if highPrecisionAct is checked.
+    QImage                      highPrecisionOutput;        //!< Last quantised highPrecisionImage, it is rebuilt if the workspaceArea image no longer matches.
+
+    QTimer                      bufferPoolTimer;            //!< Frees the pooled image buffers once no image was opened for a while.
+    static const int            BUFFER_POOL_IDLE_MSEC = 30000;  //!< Idle time before the pooled image buffers are freed.
 
     QTreeWidgetItem*            histogram;                  //!< The parent wrapper of the histogram widget.
     QTreeWidgetItem*            basicControls;              //!< The parent wrapper of the basicControls widget.
@@ -94,7 +94,7 @@ void BasicControls::on_beginCutoutPushButton_clicked()
     }
     else if (ui->magicCutRadioButton->isChecked())
     {
-        emit crossCursorChanged(WorkspaceArea::CursorMode::MAGICWAND, ui->magicSpinBox->value());
+        emit crossCursorChanged(WorkspaceArea::CursorMode::MAGICWAND, ui->magicSpinBox->value(), ui->magicModeComboBox->currentIndex());
     }
 }
 
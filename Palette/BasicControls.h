@@ -28,7 +28,7 @@ private slots:
     void on_resizePushButton_clicked();
 
 signals:
-    void crossCursorChanged(WorkspaceArea::CursorMode, int data = 0);
+    void crossCursorChanged(WorkspaceArea::CursorMode, int data = 0, int option = 0);
     void applyTransformClicked(AbstractImageFilterTransform* transform, int size, double strength, bool fromServer = false);
     void resizeButtonClicked(int, int, bool fromServer = false);
 
@@ -17,6 +17,7 @@
 #include "../FilterTransform/NonKernelBased/BrightnessFilter.h"
 #include "../FilterTransform/NonKernelBased/ContrastFilter.h"
 #include "../FilterTransform/NonKernelBased/ExposureFilter.h"
+#include "../FilterTransform/NonKernelBased/AutoLevelsFilter.h"
 
 /**
  * @brief Construct a new Color Controls:: Color Controls object
@@ -141,6 +142,24 @@ void ColorControls::on_applyLightingButton_clicked()
     }
 }
 
+/**
+ * @brief Emits auto levels filter signal to main window.
+ */
+void ColorControls::on_autoLevelsButton_clicked()
+{
+    AutoLevelsFilter *autoLevelsFilter = new AutoLevelsFilter(AutoLevelsFilter::LEVELS);
+    emit applyColorFilterClicked(autoLevelsFilter, 1, AutoLevelsFilter::DEFAULT_CLIP_PERCENT);
+}
+
+/**
+ * @brief Emits auto contrast filter signal to main window.
+ */
+void ColorControls::on_autoContrastButton_clicked()
+{
+    AutoLevelsFilter *autoContrastFilter = new AutoLevelsFilter(AutoLevelsFilter::CONTRAST);
+    emit applyColorFilterClicked(autoContrastFilter, 1, AutoLevelsFilter::DEFAULT_CLIP_PERCENT);
+}
+
 /**
  * @brief Sets image previewer image to image.
  * 
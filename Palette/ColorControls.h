@@ -21,6 +21,8 @@ private slots:
     void on_invertButton_clicked();
     void on_applyColorButton_clicked();
     void on_applyLightingButton_clicked();
+    void on_autoLevelsButton_clicked();
+    void on_autoContrastButton_clicked();
     void onSliderValueChanged(int, int);
 
 private:
@@ -11,6 +11,8 @@
 #include "FilterTransform/KernelBased/EdgeDetectionFilter.h"
 #include "FilterTransform/KernelBased/ImageInpainting.h"
 #include "FilterTransform/KernelBased/ImageScissors.h"
+#include "FilterTransform/NonKernelBased/FastMarchingInpainting.h"
+#include "FilterTransform/NonKernelBased/ClaheFilter.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -29,6 +31,14 @@ Effects::Effects(QWidget *parent) : QWidget(parent),
     logoEffect.load(":/icons/resources/effects-logo.svg");
     logoEffect = logoEffect.scaled(ui->effectLogo->size(), Qt::KeepAspectRatio);
     ui->effectLogo->setPixmap(logoEffect);
+
+    // The clip limit is fractional, its slider moves in steps of 1 / CLAHE_CLIP_LIMIT_STEPS
+    connect(ui->claheClipLimitSlider, &QSlider::valueChanged, this, [this](int value) {
+        ui->claheClipLimitSpinBox->setValue(static_cast<double>(value) / CLAHE_CLIP_LIMIT_STEPS);
+    });
+    connect(ui->claheClipLimitSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this](double value) {
+        ui->claheClipLimitSlider->setValue(qRound(value * CLAHE_CLIP_LIMIT_STEPS));
+    });
 }
 
 /**
@@ -78,6 +88,15 @@ void Effects::on_edgePushButton_clicked()
     emit applyEffectClicked(edgeDetectionFilter, ui->edgeSizeSlider->value(), 1);
 }
 
+/**
+ * @brief Emits CLAHE filter signal to mainwindow. The size is the number of tiles per side, the strength the clip limit.
+ */
+void Effects::on_clahePushButton_clicked()
+{
+    ClaheFilter* claheFilter = new ClaheFilter(ui->claheTilesSlider->value());
+    emit applyEffectClicked(claheFilter, ui->claheTilesSlider->value(), ui->claheClipLimitSpinBox->value());
+}
+
 /**
  * @brief Opens get file dialog, loads the mask.
  * 
@@ -92,7 +111,7 @@ void Effects::on_inpaintingAddMaskPushButton_clicked()
         {
             return;
         }
-        mask = imageLoaded.copy();
+        mask = PixelHelper::toWorkingFormat(imageLoaded);
     }
 }
 
@@ -107,10 +126,25 @@ void Effects::on_inpaintingPushButton_clicked()
         return;
     }
     ImageInpainting* imageInpainting = new ImageInpainting(3);
-    imageInpainting->mask = mask;
+    imageInpainting->setMask(mask);
     emit applyEffectClicked(imageInpainting, 3, 1);
 }
 
+/**
+ * @brief Emits fast marching inpainting signal to mainwindow. Uses the inpainting mask.
+ * 
+ */
+void Effects::on_fastMarchingPushButton_clicked()
+{
+    if (mask.isNull()) {
+        QMessageBox::information(this, QString("No Mask"), QString("Please add mask first."));
+        return;
+    }
+    FastMarchingInpainting* fastMarchingInpainting = new FastMarchingInpainting(5);
+    fastMarchingInpainting->setMask(mask);
+    emit applyEffectClicked(fastMarchingInpainting, 5, 1);
+}
+
 /**
  * @brief Opens get file dialog, loads the mask.
  * 
@@ -125,7 +159,7 @@ void Effects::on_imageScissorsAddMaskPushButton_clicked()
         {
             return;
         }
-        mask = imageLoaded.copy();
+        mask = PixelHelper::toWorkingFormat(imageLoaded);
     }
 }
 
@@ -140,6 +174,6 @@ void Effects::on_imageScissorsPushButton_clicked()
         return;
     }
     ImageScissors* imageScissors = new ImageScissors(2);
-    imageScissors->mask = mask;
+    imageScissors->setMask(mask);
     emit applyEffectClicked(imageScissors, 2 , 1);
 }
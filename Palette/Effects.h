@@ -21,8 +21,10 @@ private slots:
     void on_meanPushButton_clicked();
     void on_embossPushButton_clicked();
     void on_edgePushButton_clicked();
+    void on_clahePushButton_clicked();
     void on_inpaintingAddMaskPushButton_clicked();
     void on_inpaintingPushButton_clicked();
+    void on_fastMarchingPushButton_clicked();
     void on_imageScissorsAddMaskPushButton_clicked();
     void on_imageScissorsPushButton_clicked();
 
@@ -31,6 +33,9 @@ private:
     QString maskFileName;   //!< Mask file name. Masks are used for image inpainting and image scissors.
     QImage mask;            //!< Mask image.
 
+public:
+    static const int CLAHE_CLIP_LIMIT_STEPS = 10;  //!< Clip limit slider steps per unit, the clip limit has one decimal.
+
 signals:
     void applyEffectClicked(AbstractImageFilterTransform* transform, int size, double strength, bool fromServer = false);
 };
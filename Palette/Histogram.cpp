@@ -5,8 +5,10 @@
 
 #include "Histogram.h"
 #include "ui_Histogram.h"
-#include "qcustomplot.cpp"
 #include "WorkspaceArea.h"
+#include "../Utilities/ImageStatistics.h"
+
+#include <QtConcurrent>
 
 /**
  * @brief Construct a new Histogram:: Histogram object
@@ -17,33 +19,12 @@ Histogram::Histogram(QWidget *parent) : QWidget(parent),
                                         ui(new Ui::Histogram)
 {
     ui->setupUi(this);
-    //Setup grey bar
-    mpHistogramBarsGrey = new QCPBars(ui->plot->xAxis, ui->plot->yAxis);
-    QColor gray70 = Qt::gray;
-    gray70.setAlphaF(0.7);
-    mpHistogramBarsGrey->setPen(QPen(gray70));
-    mpHistogramBarsGrey->setBrush(QBrush(gray70));
-
-    //Setup red bar
-    mpHistogramBarsRed = new QCPBars(ui->plot->xAxis, ui->plot->yAxis);
-    QColor red70 = Qt::red;
-    red70.setAlphaF(0.5);
-    mpHistogramBarsRed->setPen(QPen(red70));
-    mpHistogramBarsRed->setBrush(QBrush(red70));
 
-    //Setup green bar
-    mpHistogramBarsGreen = new QCPBars(ui->plot->xAxis, ui->plot->yAxis);
-    QColor green70 = Qt::green;
-    green70.setAlphaF(0.3);
-    mpHistogramBarsGreen->setPen(QPen(green70));
-    mpHistogramBarsGreen->setBrush(QBrush(green70));
-
-    //Setup blue bar
-    mpHistogramBarsBlue = new QCPBars(ui->plot->xAxis, ui->plot->yAxis);
-    QColor blue70 = Qt::blue;
-    blue70.setAlphaF(0.3);
-    mpHistogramBarsBlue->setPen(QPen(blue70));
-    mpHistogramBarsBlue->setBrush(QBrush(blue70));
+    // Exact counts are computed in a worker thread, for the latest image only
+    countTimer.setSingleShot(true);
+    countTimer.setInterval(DEBOUNCE_MS);
+    connect(&countTimer, &QTimer::timeout, this, &Histogram::startCount);
+    connect(&countWatcher, &QFutureWatcher<ImageHistogram>::finished, this, &Histogram::onCountFinished);
 }
 
 /**
@@ -52,52 +33,82 @@ Histogram::Histogram(QWidget *parent) : QWidget(parent),
  */
 Histogram::~Histogram()
 {
-    ui->plot->clearPlottables();
+    countTimer.stop();
+    countWatcher.disconnect(this);
+    countWatcher.waitForFinished();
     delete ui;
 }
 
 /**
  * @brief Creates the histogram based on image.
+ * @details The exact counts are computed in a worker thread once no new image arrived for DEBOUNCE_MS,
+ * so a burst of images is counted once, for the last one. Large images show a sampled estimate immediately.
  * 
  * @param image Histogram to be created based on this image.
  */
 void Histogram::drawHistogram(const QImage &image)
 {
-    QVector<double> keys(256);
-    QVector<double> valuesGrey(256);
-    QVector<double> valuesRed(256);
-    QVector<double> valuesGreen(256);
-    QVector<double> valuesBlue(256);
+    histogramImage = image;
+    if (ImageStatistics::isCached(image))
+    {
+        bins = ImageStatistics::of(image).histogram();
+        exact = true;
+        plot();
+        return;
+    }
+    exact = false;
+    if (samplingEnabled && static_cast<qint64>(image.width()) * image.height() > SAMPLING_THRESHOLD)
+    {
+        bins = ImageHistogram::sample(image, SAMPLES);
+        plot();
+    }
+    countTimer.start();
+}
 
-    for (int i = 0; i < keys.size(); i++)
+/**
+ * @brief Counts histogramImage in a worker thread, unless a count is still running.
+ * @details A running count is not interrupted, onCountFinished() starts the next one if the image changed meanwhile.
+ */
+void Histogram::startCount()
+{
+    if (countWatcher.isRunning() || histogramImage.isNull())
     {
-        keys[i] = i;
-        valuesGrey[i] = 0;
-        valuesRed[i] = 0;
-        valuesGreen[i] = 0;
-        valuesBlue[i] = 0;
+        return;
     }
-    for (int j = 0; j < image.height(); j++)
+    countingImage = histogramImage;
+    // Counted through the statistics cache, so filters asking for this image version later do not count again
+    const QImage image = countingImage;
+    countWatcher.setFuture(QtConcurrent::run([image]() {
+        return ImageStatistics::of(image).histogram();
+    }));
+}
+
+/**
+ * @brief Shows the counts of the finished count, or counts the latest image if it changed meanwhile.
+ */
+void Histogram::onCountFinished()
+{
+    if (exact)
     {
-        for (int i = 0; i < image.width(); i++)
-        {
-            QRgb rgb = image.pixel(i, j); // RGB -> Y
-            int yGrey = qBound(0, static_cast<int>(0.299 * qRed(rgb) + 0.587 * qGreen(rgb) + 0.114 * qBlue(rgb) + 0.5), 255);
-            int yRed = qBound(0, static_cast<int>(1.0 * qRed(rgb) + 0.5), 255);
-            int yGreen = qBound(0, static_cast<int>(1.0 * qGreen(rgb) + 0.5), 255);
-            int yBlue = qBound(0, static_cast<int>(1.0 * qBlue(rgb) + 0.5), 255);
-            valuesGrey[yGrey] += 1.0;
-            valuesRed[yRed] += 1.0;
-            valuesGreen[yGreen] += 1.0;
-            valuesBlue[yBlue] += 1.0;
-        }
+        return;
     }
-    mpHistogramBarsGrey->setData(keys, valuesGrey);
-    mpHistogramBarsRed->setData(keys, valuesRed);
-    mpHistogramBarsGreen->setData(keys, valuesGreen);
-    mpHistogramBarsBlue->setData(keys, valuesBlue);
-    ui->plot->rescaleAxes();
-    ui->plot->replot();
+    if (countingImage.cacheKey() != histogramImage.cacheKey() && countingImage != histogramImage)
+    {
+        startCount();
+        return;
+    }
+    bins = countWatcher.result();
+    exact = true;
+    countingImage = QImage();
+    plot();
+}
+
+/**
+ * @brief Plots the current bins.
+ */
+void Histogram::plot()
+{
+    ui->plot->setBins(bins);
 }
 
 /**
@@ -107,5 +118,96 @@ void Histogram::drawHistogram(const QImage &image)
  */
 void Histogram::onImageLoaded(const QImage &image)
 {
+    // Already counted, e.g. through onPointOperationsApplied()
+    if (describes(image))
+    {
+        histogramImage = image;
+        return;
+    }
     drawHistogram(image);
 }
+
+/**
+ * @brief Updates the histogram after point operations, showing remapped bins at once.
+ * @details If every operation maps the channels independently (see AbstractNonKernelBasedImageFilterTransform::isChannelSeparable()),
+ * the operations are composed into one look-up table per channel and the bins are remapped through it.
+ * Otherwise after is counted from scratch.
+ * The remapped red, green and blue bins are exact, but luma depends on all three channels together,
+ * which per-channel bins do not record, so the GREY bins may be a bin off for colored pixels (see ImageHistogram::isLumaApproximate()).
+ * The image is not counted again, the cost depends on the number of bins only.
+ *
+ * @param before Image the operations were applied to.
+ * @param after Result of the operations.
+ * @param operations Applied point operations.
+ */
+void Histogram::onPointOperationsApplied(const QImage &before, const QImage &after, const OperationGraph &operations)
+{
+    bool separable = exact && describes(before);
+    for (const OperationGraph::Node &node : operations.getNodes())
+    {
+        separable = separable && node.pointOperation && node.pointOperation->isChannelSeparable();
+    }
+    if (!separable)
+    {
+        drawHistogram(after);
+        return;
+    }
+
+    uchar red[ImageHistogram::BINS], green[ImageHistogram::BINS], blue[ImageHistogram::BINS];
+    for (int value = 0; value < ImageHistogram::BINS; value++)
+    {
+        red[value] = green[value] = blue[value] = static_cast<uchar>(value);
+    }
+    for (const OperationGraph::Node &node : operations.getNodes())
+    {
+        for (int value = 0; value < ImageHistogram::BINS; value++)
+        {
+            QRgb mapped = node.pointOperation->applyToPixel(qRgb(red[value], green[value], blue[value]), node.strength);
+            red[value] = static_cast<uchar>(qRed(mapped));
+            green[value] = static_cast<uchar>(qGreen(mapped));
+            blue[value] = static_cast<uchar>(qBlue(mapped));
+        }
+    }
+    bins.remap(red, green, blue);
+    histogramImage = after;
+    plot();
+}
+
+/**
+ * @brief Updates the histogram after a local edit, e.g. a brush stroke.
+ * @details The old pixels of region are removed from the bins and the new ones are added,
+ * so the cost depends on the size of region only. after must equal the counted image outside region.
+ *
+ * @param after Image after the edit.
+ * @param region Region that may have changed.
+ */
+void Histogram::onRegionChanged(const QImage &after, const QRect &region)
+{
+    if (!exact || histogramImage.size() != after.size())
+    {
+        drawHistogram(after);
+        return;
+    }
+    bins.subtract(histogramImage, region);
+    bins.add(after, region);
+    histogramImage = after;
+    ImageStatistics::insert(after, bins);
+    plot();
+}
+
+/**
+ * @brief Checks whether the bins are the counts of image.
+ *
+ * @param image Image to check.
+ * @return true The bins describe image.
+ * @return false image has to be counted.
+ */
+bool Histogram::describes(const QImage &image) const
+{
+    if (histogramImage.isNull())
+    {
+        return false;
+    }
+    // Same pixel data, or a new rendering with the same pixels
+    return histogramImage.cacheKey() == image.cacheKey() || histogramImage == image;
+}
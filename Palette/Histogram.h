@@ -2,7 +2,10 @@
 #define HISTOGRAM_H
 
 #include <QWidget>
-#include "qcustomplot.h"
+#include <QTimer>
+#include <QFutureWatcher>
+#include "../Utilities/ImageHistogram.h"
+#include "../FilterTransform/OperationGraph.h"
 
 namespace Ui {
 class Histogram;
@@ -16,18 +19,33 @@ public:
     explicit Histogram(QWidget *parent = nullptr);
     ~Histogram();
 
-    QCPBars* mpHistogramBarsGrey;   //!< Bar for grey color
-    QCPBars* mpHistogramBarsRed;    //!< Bar for red color
-    QCPBars* mpHistogramBarsGreen;  //!< Bar for green color
-    QCPBars* mpHistogramBarsBlue;   //!< Bar for blue color
-
     void drawHistogram (const QImage& image);
+    void setSamplingEnabled(bool enabled) { samplingEnabled = enabled; }    //!< Shows a sampled estimate of large images until the exact counts arrive.
+
+    static const int DEBOUNCE_MS = 100;                 //!< Quiet time before a count starts, later requests restart it.
+    static const int SAMPLING_THRESHOLD = 4000000;      //!< Images with more pixels get a sampled estimate first.
+    static const int SAMPLES = 250000;                  //!< Pixels read for the sampled estimate.
+
+private:
+    bool describes(const QImage& image) const;
+    void plot();
+    void startCount();
+    void onCountFinished();
 
 private:
     Ui::Histogram *ui;
+    ImageHistogram bins;        //!< Counts of histogramImage, or an estimate until exact is true.
+    QImage histogramImage;      //!< Image the bins were counted from, or updated to.
+    bool exact = false;         //!< True if bins are the exact counts of histogramImage, except for remapped luma (see ImageHistogram::isLumaApproximate()).
+    bool samplingEnabled = true;    //!< Large images get a sampled estimate first.
+    QTimer countTimer;          //!< Debounces counts, see DEBOUNCE_MS.
+    QFutureWatcher<ImageHistogram> countWatcher;    //!< Count running in a worker thread.
+    QImage countingImage;       //!< Image of the running count.
 
 public slots:
     void onImageLoaded(const QImage& image);
+    void onPointOperationsApplied(const QImage& before, const QImage& after, const OperationGraph& operations);
+    void onRegionChanged(const QImage& after, const QRect& region);
 };
 
 #endif // HISTOGRAM_H
@@ -0,0 +1,100 @@
+/**
+ * @class HistogramPlot
+ * @brief Draws the luma, red, green and blue bins of an ImageHistogram.
+ * @details The channels are drawn as translucent step areas, scaled to the largest bin, into a cached pixmap.
+ * paintEvent() only blits the cache, which is rendered again when setBins() is called or the widget is resized.
+ */
+
+#include "HistogramPlot.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QPaintEvent>
+
+/**
+ * @brief Construct a new Histogram Plot:: Histogram Plot object
+ *
+ * @param parent Passed to QWidget() constructor.
+ */
+HistogramPlot::HistogramPlot(QWidget *parent) : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+/**
+ * @brief Sets the bins to draw and schedules a repaint.
+ *
+ * @param histogram Counts to draw.
+ */
+void HistogramPlot::setBins(const ImageHistogram &histogram)
+{
+    bins = histogram;
+    cacheValid = false;
+    update();
+}
+
+/**
+ * @brief Paints the cached plot, rendering it first if the bins or the size changed.
+ *
+ * @param event Paint event.
+ */
+void HistogramPlot::paintEvent(QPaintEvent *event)
+{
+    if (!cacheValid || cache.size() != size() * devicePixelRatioF())
+    {
+        renderCache();
+    }
+    QPainter painter(this);
+    painter.drawPixmap(event->rect(), cache, QRectF(QPointF(event->rect().topLeft()) * devicePixelRatioF(),
+                                                    QSizeF(event->rect().size()) * devicePixelRatioF()));
+}
+
+/**
+ * @brief Renders the four channels into cache.
+ */
+void HistogramPlot::renderCache()
+{
+    const qreal ratio = devicePixelRatioF();
+    cache = QPixmap(size() * ratio);
+    cache.setDevicePixelRatio(ratio);
+    cache.fill(palette().color(QPalette::Base));
+    cacheValid = true;
+
+    const qint64 maximum = bins.maximum();
+    if (maximum == 0)
+    {
+        return;
+    }
+
+    // Same colors as the former bar plot
+    struct Series { ImageHistogram::Channel channel; QColor color; qreal alpha; };
+    const Series series[ImageHistogram::CHANNELS] = {
+        {ImageHistogram::GREY, Qt::gray, 0.7},
+        {ImageHistogram::RED, Qt::red, 0.5},
+        {ImageHistogram::GREEN, Qt::green, 0.3},
+        {ImageHistogram::BLUE, Qt::blue, 0.3},
+    };
+
+    QPainter painter(&cache);
+    painter.setPen(Qt::NoPen);
+    const qreal binWidth = qreal(width()) / ImageHistogram::BINS;
+    const qreal scale = qreal(height()) / maximum;
+    for (const Series &item : series)
+    {
+        const qint64 *counts = bins.channel(item.channel);
+        QPainterPath path(QPointF(0, height()));
+        for (int value = 0; value < ImageHistogram::BINS; value++)
+        {
+            const qreal top = height() - counts[value] * scale;
+            path.lineTo(value * binWidth, top);
+            path.lineTo((value + 1) * binWidth, top);
+        }
+        path.lineTo(width(), height());
+        path.closeSubpath();
+
+        QColor color = item.color;
+        color.setAlphaF(item.alpha);
+        painter.setBrush(color);
+        painter.drawPath(path);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef HISTOGRAMPLOT_H
+#define HISTOGRAMPLOT_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QColor>
+
+#include "../Utilities/ImageHistogram.h"
+
+class HistogramPlot : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HistogramPlot(QWidget *parent = nullptr);
+
+    void setBins(const ImageHistogram& histogram);
+
+protected:
+    virtual void paintEvent(QPaintEvent *event) override;
+
+private:
+    void renderCache();
+
+private:
+    ImageHistogram bins;        //!< Counts to draw.
+    QPixmap cache;              //!< Rendered plot, redrawn only when the bins or the widget size change.
+    bool cacheValid = false;    //!< False if cache has to be rendered again.
+};
+
+#endif // HISTOGRAMPLOT_H
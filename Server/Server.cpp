@@ -131,7 +131,7 @@ void Server::jsonReceived(ServerWorker *sender, const QJsonObject &json)
         usernamesMsg["usernames"] = usernames;
         broadcast(usernamesMsg);
     }
-    else if (type == "applyFilter" || type == "applyFilterWithMask" || type == "applyResize" ||
+    else if (type == "applyFilter" || type == "applyFilterWithMask" || type == "applyFilterChain" || type == "applyResize" ||
              type == "applyCrop" || type == "applyCropWithMagicWand" || type == "initialImage" ||
              type == "versionControl" || type == "applyMoveScribble" || type == "applyReleaseScribble" || type == "applyClear")
     {
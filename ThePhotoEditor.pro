@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui printsupport network
+QT       += core gui printsupport network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -36,11 +36,14 @@ SOURCES += \
         FilterTransform/KernelBased/ImageInpainting.cpp \
         FilterTransform/KernelBased/ImageScissors.cpp \
         FilterTransform/KernelBased/MeanBlurFilter.cpp \
+        FilterTransform/NonKernelBased/AutoLevelsFilter.cpp \
         FilterTransform/NonKernelBased/BrightnessFilter.cpp \
+        FilterTransform/NonKernelBased/ClaheFilter.cpp \
         FilterTransform/NonKernelBased/ClockwiseRotationTransform.cpp \
         FilterTransform/NonKernelBased/ContrastFilter.cpp \
         FilterTransform/NonKernelBased/CounterClockwiseRotationTransform.cpp \
         FilterTransform/NonKernelBased/ExposureFilter.cpp \
+        FilterTransform/NonKernelBased/FastMarchingInpainting.cpp \
         FilterTransform/NonKernelBased/FlipHorizontalTransform.cpp \
         FilterTransform/NonKernelBased/FlipVerticalTransform.cpp \
         FilterTransform/NonKernelBased/GrayscaleFilter.cpp \
@@ -50,23 +53,33 @@ SOURCES += \
         FilterTransform/NonKernelBased/SaturationFilter.cpp \
         FilterTransform/NonKernelBased/TemperatureFilter.cpp \
         FilterTransform/NonKernelBased/TintFilter.cpp \
+        FilterTransform/OperationGraph.cpp \
         Palette/BasicControls.cpp \
         Palette/Brush.cpp \
         Palette/ColorControls.cpp \
         Palette/Effects.cpp \
         Palette/Histogram.cpp \
+        Palette/HistogramPlot.cpp \
         Server/Client.cpp \
         Server/Server.cpp \
         Server/ServerWorker.cpp \
         ServerRoom.cpp \
+        Utilities/BitMask.cpp \
         Utilities/CommitDialog.cpp \
+        Utilities/FloatImage.cpp \
+        Utilities/ImageBufferPool.cpp \
+        Utilities/ImageHistogram.cpp \
+        Utilities/ImageStatistics.cpp \
         Utilities/PixelHelper.cpp \
+        Utilities/SelectionOverlayItem.cpp \
+        Utilities/StrokeItem.cpp \
+        Utilities/SuperpixelIndex.cpp \
+        Utilities/TiledImage.cpp \
         Utilities/VersionControl.cpp \
         Utilities/WindowHelper.cpp \
         WorkspaceArea.cpp \
         main.cpp \
-        MainWindow.cpp \
-        qcustomplot.cpp
+        MainWindow.cpp
 
 HEADERS += \
         AboutUs.h \
@@ -80,11 +93,14 @@ HEADERS += \
         FilterTransform/KernelBased/ImageInpainting.h \
         FilterTransform/KernelBased/ImageScissors.h \
         FilterTransform/KernelBased/MeanBlurFilter.h \
+        FilterTransform/NonKernelBased/AutoLevelsFilter.h \
         FilterTransform/NonKernelBased/BrightnessFilter.h \
+        FilterTransform/NonKernelBased/ClaheFilter.h \
         FilterTransform/NonKernelBased/ClockwiseRotationTransform.h \
         FilterTransform/NonKernelBased/ContrastFilter.h \
         FilterTransform/NonKernelBased/CounterClockwiseRotationTransform.h \
         FilterTransform/NonKernelBased/ExposureFilter.h \
+        FilterTransform/NonKernelBased/FastMarchingInpainting.h \
         FilterTransform/NonKernelBased/FlipHorizontalTransform.h \
         FilterTransform/NonKernelBased/FlipVerticalTransform.h \
         FilterTransform/NonKernelBased/GrayscaleFilter.h \
@@ -94,22 +110,32 @@ HEADERS += \
         FilterTransform/NonKernelBased/SaturationFilter.h \
         FilterTransform/NonKernelBased/TemperatureFilter.h \
         FilterTransform/NonKernelBased/TintFilter.h \
+        FilterTransform/OperationGraph.h \
         MainWindow.h \
         Palette/BasicControls.h \
         Palette/Brush.h \
         Palette/ColorControls.h \
         Palette/Effects.h \
         Palette/Histogram.h \
+        Palette/HistogramPlot.h \
         ServerRoom.h \
+        Utilities/BitMask.h \
         Utilities/CommitDialog.h \
+        Utilities/FloatImage.h \
+        Utilities/ImageBufferPool.h \
+        Utilities/ImageHistogram.h \
+        Utilities/ImageStatistics.h \
         Utilities/PixelHelper.h \
+        Utilities/SelectionOverlayItem.h \
+        Utilities/StrokeItem.h \
+        Utilities/SuperpixelIndex.h \
+        Utilities/TiledImage.h \
         Utilities/VersionControl.h \
         Server/Client.h \
         Server/Server.h \
         Server/ServerWorker.h \
         Utilities/WindowHelper.h \
-        WorkspaceArea.h \
-        qcustomplot.h
+        WorkspaceArea.h
 
 FORMS += \
         AboutUs.ui \
@@ -0,0 +1,211 @@
+/**
+ * @class BitMask
+ * @brief Compact selection/mask, one bit per pixel.
+ * @details Masks used by the image scissors, the inpainting filters and the magic wand only distinguish selected from unselected pixels,
+ * so they are stored as 64 pixels per word instead of one 32-bit QImage pixel each.
+ * Whole words can be tested at once, which lets callers skip empty regions in bulk, see forEachSetBit() and boundingBox().
+ * Reads outside the mask return false, so a mask smaller than the image simply leaves the rest of the image unselected.
+ */
+
+#include "BitMask.h"
+#include "PixelHelper.h"
+
+/**
+ * @brief Construct a new, null, Bit Mask:: Bit Mask object
+ */
+BitMask::BitMask()
+{
+}
+
+/**
+ * @brief Construct a new Bit Mask:: Bit Mask object with every pixel unset.
+ *
+ * @param width Width in pixels.
+ * @param height Height in pixels.
+ */
+BitMask::BitMask(int width, int height)
+    : maskWidth(width)
+    , maskHeight(height)
+    , rowWords((width + WORD_BITS - 1) / WORD_BITS)
+    , words(rowWords * height, 0)
+{
+}
+
+/**
+ * @brief Creates a mask from an image, every pixel that differs from background is set.
+ *
+ * @param image Mask image in any format.
+ * @param background Color of unselected pixels, e.g. black for inpainting masks.
+ * @return BitMask Mask with the size of image.
+ */
+BitMask BitMask::fromImage(const QImage& image, QRgb background)
+{
+    BitMask mask(image.width(), image.height());
+    QImage source = PixelHelper::toWorkingFormat(image);
+    for (int y = 0; y < source.height(); ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(source.constScanLine(y));
+        quint64* row = mask.words.data() + y * mask.rowWords;
+        for (int x = 0; x < source.width(); ++x) {
+            if (line[x] != background) {
+                row[x / WORD_BITS] |= quint64(1) << (x % WORD_BITS);
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Checks whether a pixel is set.
+ *
+ * @param x Pixel x.
+ * @param y Pixel y.
+ * @return true The pixel is inside the mask and set.
+ * @return false The pixel is unset or outside the mask.
+ */
+bool BitMask::testBit(int x, int y) const
+{
+    if (x < 0 || x >= maskWidth || y < 0 || y >= maskHeight) {
+        return false;
+    }
+    return (words[y * rowWords + x / WORD_BITS] >> (x % WORD_BITS)) & 1;
+}
+
+/**
+ * @brief Sets or clears a pixel. Pixels outside the mask are ignored.
+ *
+ * @param x Pixel x.
+ * @param y Pixel y.
+ * @param value New value.
+ */
+void BitMask::setBit(int x, int y, bool value)
+{
+    if (x < 0 || x >= maskWidth || y < 0 || y >= maskHeight) {
+        return;
+    }
+    quint64& word = words[y * rowWords + x / WORD_BITS];
+    const quint64 bit = quint64(1) << (x % WORD_BITS);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+/**
+ * @brief Sets or clears the pixels left..right (inclusive) of a row, whole words at a time.
+ *
+ * @param y Row.
+ * @param left First pixel, clipped to the mask.
+ * @param right Last pixel, clipped to the mask.
+ * @param value New value.
+ */
+void BitMask::setSpan(int y, int left, int right, bool value)
+{
+    left = qMax(left, 0);
+    right = qMin(right, maskWidth - 1);
+    if (y < 0 || y >= maskHeight || left > right) {
+        return;
+    }
+    quint64* row = words.data() + y * rowWords;
+    const int firstWord = left / WORD_BITS, lastWord = right / WORD_BITS;
+    for (int w = firstWord; w <= lastWord; ++w) {
+        const int from = w == firstWord ? left % WORD_BITS : 0;
+        const int to = w == lastWord ? right % WORD_BITS : WORD_BITS - 1;
+        const quint64 bits = (to - from + 1 == WORD_BITS) ? ~quint64(0) : (((quint64(1) << (to - from + 1)) - 1) << from);
+        row[w] = value ? (row[w] | bits) : (row[w] & ~bits);
+    }
+}
+
+/**
+ * @brief Sets or clears every pixel.
+ *
+ * @param value New value.
+ */
+void BitMask::fill(bool value)
+{
+    if (!value || isNull()) {
+        words.fill(0);
+        return;
+    }
+    words.fill(~quint64(0));
+    const int tailBits = maskWidth % WORD_BITS;
+    if (tailBits != 0) {
+        for (int y = 0; y < maskHeight; ++y) {
+            words[y * rowWords + rowWords - 1] = (quint64(1) << tailBits) - 1;
+        }
+    }
+}
+
+/**
+ * @brief Checks whether no pixel is set.
+ *
+ * @return true No pixel is set.
+ * @return false At least one pixel is set.
+ */
+bool BitMask::isEmpty() const
+{
+    for (quint64 word : words) {
+        if (word) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Counts the set pixels.
+ *
+ * @return int Number of set pixels.
+ */
+int BitMask::count() const
+{
+    int result = 0;
+    for (quint64 word : words) {
+        result += qPopulationCount(word);
+    }
+    return result;
+}
+
+/**
+ * @brief Gets the smallest rectangle containing every set pixel.
+ *
+ * @return QRect Bounding box, null if the mask is empty.
+ */
+QRect BitMask::boundingBox() const
+{
+    int left = maskWidth, top = -1, right = -1, bottom = -1;
+    for (int y = 0; y < maskHeight; ++y) {
+        const quint64* row = constRow(y);
+        for (int w = 0; w < rowWords; ++w) {
+            if (!row[w]) {
+                continue;
+            }
+            if (top < 0) {
+                top = y;
+            }
+            bottom = y;
+            left = qMin(left, w * WORD_BITS + static_cast<int>(qCountTrailingZeroBits(row[w])));
+            right = qMax(right, w * WORD_BITS + WORD_BITS - 1 - static_cast<int>(qCountLeadingZeroBits(row[w])));
+        }
+    }
+    if (top < 0) {
+        return QRect();
+    }
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+/**
+ * @brief Renders the mask as an image, e.g. to send it to the server.
+ *
+ * @param set Color of set pixels.
+ * @param unset Color of unset pixels.
+ * @return QImage Image in PixelHelper::WORKING_FORMAT.
+ */
+QImage BitMask::toImage(QRgb set, QRgb unset) const
+{
+    QImage image(maskWidth, maskHeight, PixelHelper::WORKING_FORMAT);
+    for (int y = 0; y < maskHeight; ++y) {
+        const quint64* row = constRow(y);
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < maskWidth; ++x) {
+            line[x] = ((row[x / WORD_BITS] >> (x % WORD_BITS)) & 1) ? set : unset;
+        }
+    }
+    return image;
+}
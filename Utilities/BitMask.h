@@ -0,0 +1,68 @@
+#ifndef BITMASK_H
+#define BITMASK_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include <QtAlgorithms>
+
+class BitMask
+{
+public:
+    BitMask();
+    BitMask(int width, int height);
+    static BitMask fromImage(const QImage& image, QRgb background);
+
+public:
+    int                         width() const { return maskWidth; }                     //!< Mask width in pixels.
+    int                         height() const { return maskHeight; }                   //!< Mask height in pixels.
+    QSize                       size() const { return QSize(maskWidth, maskHeight); }   //!< Mask size in pixels.
+    bool                        isNull() const { return words.isEmpty(); }              //!< True if the mask has no pixels.
+    int                         wordsPerRow() const { return rowWords; }                //!< Number of 64-bit words per row.
+    const quint64*              constRow(int y) const { return words.constData() + y * rowWords; }  //!< Words of row y, bit i of word w is pixel w * 64 + i.
+    quint64*                    row(int y) { return words.data() + y * rowWords; }                  //!< Writable words of row y, padding bits must stay 0.
+
+    bool                        testBit(int x, int y) const;
+    void                        setBit(int x, int y, bool value = true);
+    void                        setSpan(int y, int left, int right, bool value = true);
+    void                        fill(bool value);
+    bool                        isEmpty() const;
+    int                         count() const;
+    QRect                       boundingBox() const;
+    QImage                      toImage(QRgb set, QRgb unset) const;
+
+    template <typename Function>
+    void                        forEachSetBit(Function function) const;
+
+public:
+    static const int WORD_BITS = 64;    //!< Pixels per word.
+
+private:
+    int                         maskWidth = 0;      //!< Width of the mask.
+    int                         maskHeight = 0;     //!< Height of the mask.
+    int                         rowWords = 0;       //!< Words per row, every row starts at a word boundary.
+    QVector<quint64>            words;              //!< Row-major bits, padding bits at the end of a row are always 0.
+};
+
+/**
+ * @brief Calls function(x, y) for every set pixel, in row-major order.
+ * @details Zero words are skipped 64 pixels at a time, only set bits are visited within the other words.
+ *
+ * @param function Called with the position of every set pixel.
+ */
+template <typename Function>
+void BitMask::forEachSetBit(Function function) const
+{
+    for (int y = 0; y < maskHeight; ++y) {
+        const quint64* row = constRow(y);
+        for (int w = 0; w < rowWords; ++w) {
+            quint64 word = row[w];
+            while (word) {
+                function(w * WORD_BITS + static_cast<int>(qCountTrailingZeroBits(word)), y);
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+#endif // BITMASK_H
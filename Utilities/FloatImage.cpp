@@ -0,0 +1,222 @@
+/**
+ * @class FloatImage
+ * @brief High precision working buffer, one float per channel.
+ * @details Channel values are the image's encoded (sRGB) values scaled to 0..1, the same values the 8-bit filters operate on,
+ * so a filter means the same thing in both representations. Values are not clamped or quantised between edits,
+ * intermediate results may leave the 0..1 range and come back without loss.
+ * Quantisation to 8 bits only happens in toImage(), i.e. for display and export.
+ */
+
+#include "FloatImage.h"
+#include "PixelHelper.h"
+
+#include <QtConcurrent>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Construct a new, null, Float Image:: Float Image object
+ */
+FloatImage::FloatImage()
+{
+}
+
+/**
+ * @brief Construct a new Float Image:: Float Image object from an 8-bit image.
+ *
+ * @param image Image in any format.
+ */
+FloatImage::FloatImage(const QImage& image)
+    : imageWidth(image.width())
+    , imageHeight(image.height())
+    , pixels(image.width() * image.height() * CHANNELS)
+{
+    QImage source = PixelHelper::toWorkingFormat(image);
+    for (int j = 0; j < imageHeight; ++j) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(source.constScanLine(j));
+        float* target = scanLine(j);
+        for (int i = 0; i < imageWidth; ++i) {
+            fromRgb(line[i], target + i * CHANNELS);
+        }
+    }
+}
+
+/**
+ * @brief Gets a writable row.
+ *
+ * @param y Row.
+ * @return float* First channel of the first pixel in row y.
+ */
+float* FloatImage::scanLine(int y)
+{
+    return pixels.data() + y * imageWidth * CHANNELS;
+}
+
+/**
+ * @brief Gets a read-only row.
+ *
+ * @param y Row.
+ * @return const float* First channel of the first pixel in row y.
+ */
+const float* FloatImage::constScanLine(int y) const
+{
+    return pixels.constData() + y * imageWidth * CHANNELS;
+}
+
+/**
+ * @brief Applies function to every row, bands of ROWS_PER_BAND rows are processed in parallel.
+ *
+ * @param function Called with the first channel of a row and the number of pixels in it.
+ */
+void FloatImage::mapRows(const std::function<void(float*, int)>& function)
+{
+    QVector<int> bands((imageHeight + ROWS_PER_BAND - 1) / ROWS_PER_BAND);
+    for (int i = 0; i < bands.size(); ++i) {
+        bands[i] = i * ROWS_PER_BAND;
+    }
+    // Detach once here, worker threads must not race to detach pixels shared with a copy
+    float* data = pixels.data();
+    QtConcurrent::blockingMap(bands, [this, data, &function](int firstRow) {
+        int lastRow = qMin(firstRow + ROWS_PER_BAND, imageHeight);
+        for (int y = firstRow; y < lastRow; ++y) {
+            function(data + y * imageWidth * CHANNELS, imageWidth);
+        }
+    });
+}
+
+/**
+ * @brief Quantises the image to 8 bits per channel.
+ *
+ * @return QImage Image in PixelHelper::WORKING_FORMAT, channels clamped to 0..255.
+ */
+QImage FloatImage::toImage() const
+{
+    QImage image(imageWidth, imageHeight, PixelHelper::WORKING_FORMAT);
+    for (int j = 0; j < imageHeight; ++j) {
+        const float* line = constScanLine(j);
+        QRgb* target = reinterpret_cast<QRgb*>(image.scanLine(j));
+        for (int i = 0; i < imageWidth; ++i) {
+            target[i] = toRgb(line + i * CHANNELS);
+        }
+    }
+    return image;
+}
+
+/**
+ * @brief Quantises one pixel.
+ *
+ * @param pixel RGBA floats.
+ * @return QRgb Pixel with every channel rounded and clamped to 0..255.
+ */
+QRgb FloatImage::toRgb(const float* pixel)
+{
+    return qRgba(qBound(0, static_cast<int>(pixel[0] * 255.0f + 0.5f), 255),
+                 qBound(0, static_cast<int>(pixel[1] * 255.0f + 0.5f), 255),
+                 qBound(0, static_cast<int>(pixel[2] * 255.0f + 0.5f), 255),
+                 qBound(0, static_cast<int>(pixel[3] * 255.0f + 0.5f), 255));
+}
+
+/**
+ * @brief Dequantises one pixel.
+ *
+ * @param rgb 8-bit pixel.
+ * @param pixel Receives the RGBA floats.
+ */
+void FloatImage::fromRgb(QRgb rgb, float* pixel)
+{
+    pixel[0] = qRed(rgb) / 255.0f;
+    pixel[1] = qGreen(rgb) / 255.0f;
+    pixel[2] = qBlue(rgb) / 255.0f;
+    pixel[3] = qAlpha(rgb) / 255.0f;
+}
+
+/**
+ * @brief Converts the colour of a pixel to HSV, like QColor::getHsvF() but without clamping.
+ *
+ * @param pixel RGBA floats, alpha is ignored.
+ * @param hue Receives the hue in degrees, 0..360, or -1 for achromatic colours.
+ * @param saturation Receives the saturation.
+ * @param value Receives the value, i.e. the largest colour channel.
+ */
+void FloatImage::toHsv(const float* pixel, float& hue, float& saturation, float& value)
+{
+    const float maximum = qMax(pixel[0], qMax(pixel[1], pixel[2]));
+    const float minimum = qMin(pixel[0], qMin(pixel[1], pixel[2]));
+    const float delta = maximum - minimum;
+    value = maximum;
+    saturation = maximum > 0.0f ? delta / maximum : 0.0f;
+    if (delta <= 0.0f) {
+        hue = -1.0f;
+        return;
+    }
+    if (maximum == pixel[0]) {
+        hue = (pixel[1] - pixel[2]) / delta;
+    }
+    else if (maximum == pixel[1]) {
+        hue = 2.0f + (pixel[2] - pixel[0]) / delta;
+    }
+    else {
+        hue = 4.0f + (pixel[0] - pixel[1]) / delta;
+    }
+    hue *= 60.0f;
+    if (hue < 0.0f) {
+        hue += 360.0f;
+    }
+}
+
+/**
+ * @brief Sets the colour of a pixel from HSV, the inverse of toHsv(). Alpha is left unchanged.
+ *
+ * @param hue Hue in degrees, 0..360, or -1 for achromatic colours.
+ * @param saturation Saturation.
+ * @param value Value.
+ * @param pixel Receives the red, green and blue floats.
+ */
+void FloatImage::fromHsv(float hue, float saturation, float value, float* pixel)
+{
+    if (hue < 0.0f || saturation <= 0.0f) {
+        pixel[0] = pixel[1] = pixel[2] = value;
+        return;
+    }
+    const float sector = (hue >= 360.0f ? 0.0f : hue) / 60.0f;
+    const int index = static_cast<int>(sector);
+    const float fraction = sector - index;
+    const float p = value * (1.0f - saturation);
+    const float q = value * (1.0f - saturation * fraction);
+    const float t = value * (1.0f - saturation * (1.0f - fraction));
+    switch (index) {
+    case 0:  pixel[0] = value; pixel[1] = t;     pixel[2] = p;     break;
+    case 1:  pixel[0] = q;     pixel[1] = value; pixel[2] = p;     break;
+    case 2:  pixel[0] = p;     pixel[1] = value; pixel[2] = t;     break;
+    case 3:  pixel[0] = p;     pixel[1] = q;     pixel[2] = value; break;
+    case 4:  pixel[0] = t;     pixel[1] = p;     pixel[2] = value; break;
+    default: pixel[0] = value; pixel[1] = p;     pixel[2] = q;     break;
+    }
+}
+
+/**
+ * @brief Computes channel = channel * scale + offset for every channel of count pixels.
+ * @details Uses SSE2 when available, one pixel per vector.
+ *
+ * @param rgba First channel of the first pixel.
+ * @param count Number of pixels.
+ * @param scale Per channel factor, in RGBA order.
+ * @param offset Per channel offset, in RGBA order.
+ */
+void FloatImage::applyAffine(float* rgba, int count, const float scale[4], const float offset[4])
+{
+#ifdef __SSE2__
+    const __m128 scaleVector = _mm_loadu_ps(scale);
+    const __m128 offsetVector = _mm_loadu_ps(offset);
+    for (int i = 0; i < count; ++i) {
+        float* pixel = rgba + i * CHANNELS;
+        _mm_storeu_ps(pixel, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pixel), scaleVector), offsetVector));
+    }
+#else
+    for (int i = 0; i < count * CHANNELS; ++i) {
+        rgba[i] = rgba[i] * scale[i % CHANNELS] + offset[i % CHANNELS];
+    }
+#endif
+}
@@ -0,0 +1,40 @@
+#ifndef FLOATIMAGE_H
+#define FLOATIMAGE_H
+
+#include <QImage>
+#include <QVector>
+#include <functional>
+
+class FloatImage
+{
+public:
+    FloatImage();
+    explicit FloatImage(const QImage& image);
+
+public:
+    int                         width() const { return imageWidth; }            //!< Image width in pixels.
+    int                         height() const { return imageHeight; }          //!< Image height in pixels.
+    bool                        isNull() const { return pixels.isEmpty(); }     //!< True if no image is stored.
+
+    float*                      scanLine(int y);
+    const float*                constScanLine(int y) const;
+    void                        mapRows(const std::function<void(float* line, int count)>& function);
+    QImage                      toImage() const;
+
+    static QRgb                 toRgb(const float* pixel);
+    static void                 fromRgb(QRgb rgb, float* pixel);
+    static void                 toHsv(const float* pixel, float& hue, float& saturation, float& value);
+    static void                 fromHsv(float hue, float saturation, float value, float* pixel);
+    static void                 applyAffine(float* rgba, int count, const float scale[4], const float offset[4]);
+
+public:
+    static const int CHANNELS = 4;          //!< Floats per pixel: red, green, blue, alpha.
+    static const int ROWS_PER_BAND = 64;    //!< Rows processed by one task in mapRows().
+
+private:
+    int                         imageWidth = 0;     //!< Width of the image.
+    int                         imageHeight = 0;    //!< Height of the image.
+    QVector<float>              pixels;             //!< Row-major, interleaved RGBA, 1.0 is full intensity.
+};
+
+#endif // FLOATIMAGE_H
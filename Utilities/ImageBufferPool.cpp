@@ -0,0 +1,118 @@
+/**
+ * @class ImageBufferPool
+ * @brief Static class that recycles image buffers, bucketed by size and format.
+ * @details acquire() returns an image whose pixels are uninitialised, it is meant for outputs and
+ * intermediate buffers whose every pixel will be overwritten. Intermediate buffers should be given back with release(),
+ * so the next filter needing a buffer of the same size and format does not allocate.
+ * Only a few buffers, about the working set of one filter on the open image, are kept. Buffers of another size are
+ * dropped with trim() when an image is opened, and everything is freed with clear().
+ * All functions are thread safe.
+ */
+
+#include "ImageBufferPool.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+/**
+ * @brief Pooled buffers and their total size.
+ */
+struct Pool {
+    QMutex mutex;
+    QMultiHash<quint64, QImage> buckets;    // Key combines width, height and format.
+};
+
+Pool& pool()
+{
+    static Pool instance;
+    return instance;
+}
+
+quint64 bucketKey(const QSize& size, QImage::Format format)
+{
+    return (static_cast<quint64>(size.width()) << 40) | (static_cast<quint64>(size.height()) << 16) | static_cast<quint64>(format);
+}
+}
+
+/**
+ * @brief Gets an image with uninitialised pixels.
+ *
+ * @param size Image size.
+ * @param format Image format.
+ * @return QImage A pooled buffer if one of this size and format is available, else a newly allocated one.
+ */
+QImage ImageBufferPool::acquire(const QSize& size, QImage::Format format)
+{
+    {
+        QMutexLocker locker(&pool().mutex);
+        auto it = pool().buckets.find(bucketKey(size, format));
+        if (it != pool().buckets.end()) {
+            QImage image = it.value();
+            pool().buckets.erase(it);
+            return image;
+        }
+    }
+    return QImage(size, format);
+}
+
+/**
+ * @brief Gets an image with uninitialised pixels, with the size, format and color table of image.
+ *
+ * @param image Image to mimic.
+ * @return QImage Uninitialised buffer.
+ */
+QImage ImageBufferPool::acquireLike(const QImage& image)
+{
+    QImage buffer = acquire(image.size(), image.format());
+    buffer.setColorTable(image.colorTable());
+    return buffer;
+}
+
+/**
+ * @brief Returns a buffer to the pool. image is null afterwards.
+ * @details Buffers still referenced elsewhere are not pooled, as they cannot be overwritten.
+ *
+ * @param image Buffer that is no longer needed.
+ */
+void ImageBufferPool::release(QImage& image)
+{
+    if (image.isNull() || !image.isDetached()) {
+        image = QImage();
+        return;
+    }
+    QMutexLocker locker(&pool().mutex);
+    if (pool().buckets.size() < MAX_POOLED_BUFFERS) {
+        pool().buckets.insert(bucketKey(image.size(), image.format()), image);
+    }
+    image = QImage();
+}
+
+/**
+ * @brief Frees every pooled buffer.
+ */
+void ImageBufferPool::clear()
+{
+    QMutexLocker locker(&pool().mutex);
+    pool().buckets.clear();
+}
+
+/**
+ * @brief Frees every pooled buffer whose size differs from size.
+ * @details Called when an image is opened, buffers sized for the previous image would never be acquired again.
+ *
+ * @param size Size of the open image.
+ */
+void ImageBufferPool::trim(const QSize& size)
+{
+    QMutexLocker locker(&pool().mutex);
+    for (auto it = pool().buckets.begin(); it != pool().buckets.end();) {
+        if (it.value().size() != size) {
+            it = pool().buckets.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef IMAGEBUFFERPOOL_H
+#define IMAGEBUFFERPOOL_H
+
+#include <QImage>
+
+class ImageBufferPool
+{
+public:
+    ImageBufferPool() = delete;
+    static QImage acquire(const QSize& size, QImage::Format format);
+    static QImage acquireLike(const QImage& image);
+    static void release(QImage& image);
+    static void clear();
+    static void trim(const QSize& size);
+
+public:
+    static const int MAX_POOLED_BUFFERS = 4;   //!< Released buffers beyond this count are freed instead of pooled.
+};
+
+#endif // IMAGEBUFFERPOOL_H
@@ -0,0 +1,203 @@
+/**
+ * @class ImageHistogram
+ * @brief Integer luma, red, green and blue histograms of an image.
+ * @details compute() reads scanlines directly and splits the rows into a few bands per thread.
+ * Every band counts into private bins, SUB_HISTOGRAMS sets of them so that runs of equal values do not
+ * keep incrementing the same counter, and the bands are merged in order at the end.
+ */
+
+#include "ImageHistogram.h"
+#include "PixelHelper.h"
+
+#include <QtConcurrent>
+#include <QThread>
+#include <cmath>
+
+/**
+ * @brief Construct a new, empty, Image Histogram:: Image Histogram object
+ */
+ImageHistogram::ImageHistogram() : bins(CHANNELS * BINS, 0)
+{
+}
+
+/**
+ * @brief Counts every pixel of image, row bands in parallel.
+ *
+ * @param image Image to count.
+ * @return ImageHistogram Histogram of image, empty if image is null.
+ */
+ImageHistogram ImageHistogram::compute(const QImage &image)
+{
+    ImageHistogram histogram;
+    histogram.add(image, image.rect());
+    return histogram;
+}
+
+/**
+ * @brief Estimates the histogram of image from a regular grid of about samples pixels.
+ * @details Every step-th pixel of every step-th row is counted, with step chosen so about samples pixels are read,
+ * and the bins are scaled to the pixel count of image. The sample is deterministic, so the estimate is reproducible.
+ * Its cost does not depend on the image size, which makes it suitable as a preview for very large images.
+ *
+ * @param image Image to sample.
+ * @param samples Approximate number of pixels to read.
+ * @return ImageHistogram Estimated histogram, isSampled() is true unless every pixel was read.
+ */
+ImageHistogram ImageHistogram::sample(const QImage &image, int samples)
+{
+    ImageHistogram histogram;
+    if (image.isNull()) {
+        return histogram;
+    }
+    const qint64 total = static_cast<qint64>(image.width()) * image.height();
+    const int step = qMax(1, static_cast<int>(std::ceil(std::sqrt(double(total) / qMax(1, samples)))));
+    if (step == 1) {
+        return compute(image);
+    }
+    const QImage working = PixelHelper::toWorkingFormat(image);
+    qint64 counted = 0;
+    for (int j = step / 2; j < working.height(); j += step) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(working.constScanLine(j));
+        for (int i = step / 2; i < working.width(); i += step) {
+            const QRgb rgb = line[i];
+            ++histogram.bins[GREY * BINS + luma(rgb)];
+            ++histogram.bins[RED * BINS + qRed(rgb)];
+            ++histogram.bins[GREEN * BINS + qGreen(rgb)];
+            ++histogram.bins[BLUE * BINS + qBlue(rgb)];
+            ++counted;
+        }
+    }
+    if (counted > 0) {
+        for (qint64& value : histogram.bins) {
+            value = (value * total + counted / 2) / counted;
+        }
+    }
+    histogram.pixelCount = total;
+    histogram.sampled = true;
+    return histogram;
+}
+
+/**
+ * @brief Counts the pixels of a region in addition, e.g. the new pixels of an edited region.
+ *
+ * @param image Image to count.
+ * @param region Region of image to count, clipped to the image.
+ */
+void ImageHistogram::add(const QImage &image, const QRect &region)
+{
+    accumulate(image, region, 1);
+}
+
+/**
+ * @brief Removes the pixels of a region from the counts, e.g. the old pixels of an edited region.
+ *
+ * @param image Image the pixels were counted from.
+ * @param region Region of image to remove, clipped to the image.
+ */
+void ImageHistogram::subtract(const QImage &image, const QRect &region)
+{
+    accumulate(image, region, -1);
+}
+
+/**
+ * @brief Applies per channel look-up tables to the counted pixels, without the image.
+ * @details Red, green and blue are exact, their bins move to the mapped values.
+ * Luma depends on all three channels, its bins move to the luma of the mapped gray value,
+ * which is exact for gray pixels and may be a bin off for colored ones, see isLumaApproximate().
+ *
+ * @param red Table of BINS entries for red.
+ * @param green Table of BINS entries for green.
+ * @param blue Table of BINS entries for blue.
+ */
+void ImageHistogram::remap(const uchar *red, const uchar *green, const uchar *blue)
+{
+    const uchar* tables[CHANNELS] = {nullptr, red, green, blue};
+    uchar grey[BINS];
+    for (int value = 0; value < BINS; ++value) {
+        grey[value] = static_cast<uchar>(luma(qRgb(red[value], green[value], blue[value])));
+    }
+    tables[GREY] = grey;
+
+    QVector<qint64> remapped(CHANNELS * BINS, 0);
+    for (int c = 0; c < CHANNELS; ++c) {
+        for (int value = 0; value < BINS; ++value) {
+            remapped[c * BINS + tables[c][value]] += bins[c * BINS + value];
+        }
+    }
+    bins = remapped;
+    lumaApproximate = true;
+}
+
+/**
+ * @brief Adds (sign 1) or removes (sign -1) the pixels of a region, row bands in parallel.
+ *
+ * @param image Image to count.
+ * @param region Region of image, clipped to the image.
+ * @param sign 1 or -1.
+ */
+void ImageHistogram::accumulate(const QImage &image, const QRect &region, int sign)
+{
+    const QRect rect = region.intersected(image.rect());
+    if (image.isNull() || rect.isEmpty()) {
+        return;
+    }
+    const QImage working = PixelHelper::toWorkingFormat(image);
+    const int left = rect.left(), right = rect.right() + 1;
+    const int top = rect.top(), bottom = rect.bottom() + 1;
+
+    // A few bands per thread, each with its own bins
+    const int bandCount = qMin(rect.height(), qMax(1, QThread::idealThreadCount() * 4));
+    const int rowsPerBand = (rect.height() + bandCount - 1) / bandCount;
+    QVector<int> bands;
+    for (int firstRow = top; firstRow < bottom; firstRow += rowsPerBand) {
+        bands.append(firstRow);
+    }
+    QVector<QVector<quint32>> bandBins(bands.size());
+    QVector<quint32>* bandData = bandBins.data();
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        QVector<quint32> local(SUB_HISTOGRAMS * CHANNELS * BINS, 0);
+        quint32* sub[SUB_HISTOGRAMS];
+        for (int s = 0; s < SUB_HISTOGRAMS; ++s) {
+            sub[s] = local.data() + s * CHANNELS * BINS;
+        }
+        for (int j = firstRow; j < qMin(firstRow + rowsPerBand, bottom); ++j) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(working.constScanLine(j));
+            for (int i = left; i < right; ++i) {
+                const QRgb rgb = line[i];
+                quint32* counts = sub[i % SUB_HISTOGRAMS];
+                ++counts[GREY * BINS + luma(rgb)];
+                ++counts[RED * BINS + qRed(rgb)];
+                ++counts[GREEN * BINS + qGreen(rgb)];
+                ++counts[BLUE * BINS + qBlue(rgb)];
+            }
+        }
+        for (int s = 1; s < SUB_HISTOGRAMS; ++s) {
+            for (int k = 0; k < CHANNELS * BINS; ++k) {
+                local[k] += sub[s][k];
+            }
+        }
+        local.resize(CHANNELS * BINS);
+        bandData[(firstRow - top) / rowsPerBand] = local;
+    });
+
+    for (const QVector<quint32>& local : bandBins) {
+        for (int k = 0; k < CHANNELS * BINS; ++k) {
+            bins[k] += sign * static_cast<qint64>(local[k]);
+        }
+    }
+    pixelCount += sign * static_cast<qint64>(rect.width()) * rect.height();
+}
+
+/**
+ * @brief Gets the largest count of any channel, e.g. to scale a plot.
+ *
+ * @return qint64 Largest bin.
+ */
+qint64 ImageHistogram::maximum() const
+{
+    qint64 result = 0;
+    for (qint64 value : bins) {
+        result = qMax(result, value);
+    }
+    return result;
+}
@@ -0,0 +1,60 @@
+#ifndef IMAGEHISTOGRAM_H
+#define IMAGEHISTOGRAM_H
+
+#include <QImage>
+#include <QVector>
+#include <QRect>
+
+class ImageHistogram
+{
+public:
+/**
+ * @enum Channel.
+ *
+ * @brief Channels counted by the histogram.
+ */
+    enum Channel {
+        GREY,       //!< Luma, 0.299 R + 0.587 G + 0.114 B in 8-bit fixed point.
+        RED,
+        GREEN,
+        BLUE,
+        CHANNELS    //!< Number of channels.
+    };
+
+public:
+    ImageHistogram();
+    static ImageHistogram compute(const QImage& image);
+    static ImageHistogram sample(const QImage& image, int samples);
+
+    void                        add(const QImage& image, const QRect& region);
+    void                        subtract(const QImage& image, const QRect& region);
+    void                        remap(const uchar* red, const uchar* green, const uchar* blue);
+
+public:
+    qint64                      count(Channel channel, int value) const { return bins[channel * BINS + value]; }   //!< Pixels with value in channel.
+    const qint64*               channel(Channel channel) const { return bins.constData() + channel * BINS; }       //!< The BINS counts of channel.
+    qint64                      total() const { return pixelCount; }                                               //!< Number of counted pixels.
+    qint64                      maximum() const;
+    bool                        isLumaApproximate() const { return lumaApproximate; }                              //!< True if the GREY bins were remapped, see remap().
+    bool                        isSampled() const { return sampled; }                                              //!< True if only a subset of pixels was counted, see sample().
+
+    static int                  luma(QRgb rgb) { return (LUMA_RED * qRed(rgb) + LUMA_GREEN * qGreen(rgb) + LUMA_BLUE * qBlue(rgb) + 128) >> 8; }  //!< Fixed-point luma, 0..255.
+
+public:
+    static const int BINS = 256;            //!< Bins per channel, one per 8-bit value.
+    static const int LUMA_RED = 77;         //!< 0.299 in 8-bit fixed point.
+    static const int LUMA_GREEN = 150;      //!< 0.587 in 8-bit fixed point.
+    static const int LUMA_BLUE = 29;        //!< 0.114 in 8-bit fixed point.
+    static const int SUB_HISTOGRAMS = 4;    //!< Private bin sets per task, consecutive pixels go to different sets.
+
+private:
+    void                        accumulate(const QImage& image, const QRect& region, int sign);
+
+private:
+    QVector<qint64>             bins;                       //!< CHANNELS x BINS counts, channel-major.
+    qint64                      pixelCount = 0;             //!< Number of counted pixels.
+    bool                        lumaApproximate = false;    //!< GREY bins were remapped and may be off by one bin for colored pixels.
+    bool                        sampled = false;            //!< Bins are estimated from a subset of the pixels.
+};
+
+#endif // IMAGEHISTOGRAM_H
@@ -0,0 +1,178 @@
+/**
+ * @class ImageStatistics
+ * @brief Global statistics of an image version: histogram, mean, minimum, maximum and percentiles.
+ * @details Every statistic is derived from one exact ImageHistogram, counted in parallel.
+ * Results are cached per image version, keyed by QImage::cacheKey(), which changes whenever the pixels of an image change.
+ * So a modified image is never served stale statistics, and unchanged images are never scanned twice while they stay in the cache.
+ */
+
+#include "ImageStatistics.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <cmath>
+
+namespace {
+/**
+ * @brief Cached counts of one image version.
+ */
+struct Entry {
+    qint64 key;                 //!< QImage::cacheKey() of the version.
+    QSize size;                 //!< Size of the version.
+    ImageHistogram histogram;   //!< Exact counts of the version.
+};
+
+QList<Entry> cache;             //!< Most recently used first.
+QMutex cacheMutex;              //!< Guards cache, statistics are also queried from worker threads.
+
+/**
+ * @brief Finds the entry of image and moves it to the front. cacheMutex must be locked.
+ */
+bool lookUp(const QImage& image, ImageHistogram* histogram)
+{
+    for (int i = 0; i < cache.size(); ++i) {
+        if (cache[i].key == image.cacheKey() && cache[i].size == image.size()) {
+            cache.move(i, 0);
+            if (histogram) {
+                *histogram = cache.first().histogram;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+/**
+ * @brief Gets the statistics of image, counting it only if this version is not cached.
+ *
+ * @param image Image to describe.
+ * @return ImageStatistics Statistics of image.
+ */
+ImageStatistics ImageStatistics::of(const QImage &image)
+{
+    {
+        QMutexLocker locker(&cacheMutex);
+        ImageHistogram histogram;
+        if (lookUp(image, &histogram)) {
+            return ImageStatistics(histogram);
+        }
+    }
+    // Count without holding the lock, other images can be looked up meanwhile
+    const ImageHistogram histogram = ImageHistogram::compute(image);
+    insert(image, histogram);
+    return ImageStatistics(histogram);
+}
+
+/**
+ * @brief Checks whether the statistics of this version of image are cached, i.e. of() returns without counting.
+ *
+ * @param image Image to check.
+ * @return true of() is a look-up.
+ * @return false of() counts the image.
+ */
+bool ImageStatistics::isCached(const QImage &image)
+{
+    QMutexLocker locker(&cacheMutex);
+    return lookUp(image, nullptr);
+}
+
+/**
+ * @brief Stores exact counts of image that were computed elsewhere, e.g. by the Histogram palette.
+ *
+ * @param image Image the counts belong to.
+ * @param histogram Exact counts of image, sampled or remapped counts are ignored.
+ */
+void ImageStatistics::insert(const QImage &image, const ImageHistogram &histogram)
+{
+    if (image.isNull() || histogram.isSampled() || histogram.isLumaApproximate()) {
+        return;
+    }
+    QMutexLocker locker(&cacheMutex);
+    if (lookUp(image, nullptr)) {
+        return;
+    }
+    cache.prepend(Entry{image.cacheKey(), image.size(), histogram});
+    while (cache.size() > CACHE_SIZE) {
+        cache.removeLast();
+    }
+}
+
+/**
+ * @brief Gets the mean of a channel.
+ *
+ * @param channel Channel.
+ * @return double Mean value, 0 for an empty image.
+ */
+double ImageStatistics::mean(ImageHistogram::Channel channel) const
+{
+    if (isNull()) {
+        return 0;
+    }
+    const qint64* counts = bins.channel(channel);
+    qint64 sum = 0;
+    for (int value = 0; value < ImageHistogram::BINS; ++value) {
+        sum += value * counts[value];
+    }
+    return double(sum) / bins.total();
+}
+
+/**
+ * @brief Gets the smallest value of a channel.
+ *
+ * @param channel Channel.
+ * @return int Smallest value, 0 for an empty image.
+ */
+int ImageStatistics::minimum(ImageHistogram::Channel channel) const
+{
+    const qint64* counts = bins.channel(channel);
+    for (int value = 0; value < ImageHistogram::BINS; ++value) {
+        if (counts[value] > 0) {
+            return value;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Gets the largest value of a channel.
+ *
+ * @param channel Channel.
+ * @return int Largest value, 0 for an empty image.
+ */
+int ImageStatistics::maximum(ImageHistogram::Channel channel) const
+{
+    const qint64* counts = bins.channel(channel);
+    for (int value = ImageHistogram::BINS - 1; value >= 0; --value) {
+        if (counts[value] > 0) {
+            return value;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Gets the smallest value of a channel that at least fraction of the pixels do not exceed.
+ * @details percentile(channel, 0) is minimum(), percentile(channel, 1) is maximum(), 0.5 is the median.
+ *
+ * @param channel Channel.
+ * @param fraction Fraction of the pixels, 0..1.
+ * @return int Percentile value, 0 for an empty image.
+ */
+int ImageStatistics::percentile(ImageHistogram::Channel channel, double fraction) const
+{
+    if (isNull()) {
+        return 0;
+    }
+    const qint64 target = qMax<qint64>(1, static_cast<qint64>(std::ceil(qBound(0.0, fraction, 1.0) * bins.total())));
+    const qint64* counts = bins.channel(channel);
+    qint64 cumulative = 0;
+    for (int value = 0; value < ImageHistogram::BINS; ++value) {
+        cumulative += counts[value];
+        if (cumulative >= target) {
+            return value;
+        }
+    }
+    return maximum(channel);
+}
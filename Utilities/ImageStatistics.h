@@ -0,0 +1,34 @@
+#ifndef IMAGESTATISTICS_H
+#define IMAGESTATISTICS_H
+
+#include <QImage>
+
+#include "ImageHistogram.h"
+
+class ImageStatistics
+{
+public:
+    ImageStatistics() = default;
+    static ImageStatistics of(const QImage& image);
+    static bool isCached(const QImage& image);
+    static void insert(const QImage& image, const ImageHistogram& histogram);
+
+public:
+    bool                        isNull() const { return bins.total() == 0; }        //!< True for an empty image.
+    const ImageHistogram&       histogram() const { return bins; }                  //!< Luma, red, green and blue histogram.
+    double                      mean(ImageHistogram::Channel channel) const;
+    int                         minimum(ImageHistogram::Channel channel) const;
+    int                         maximum(ImageHistogram::Channel channel) const;
+    int                         percentile(ImageHistogram::Channel channel, double fraction) const;
+
+public:
+    static const int CACHE_SIZE = 8;    //!< Image versions kept, least recently used ones are dropped.
+
+private:
+    explicit ImageStatistics(const ImageHistogram& histogram) : bins(histogram) {}     //!< Statistics derived from exact bins.
+
+private:
+    ImageHistogram              bins;       //!< Exact counts of the image, every statistic is derived from them.
+};
+
+#endif // IMAGESTATISTICS_H
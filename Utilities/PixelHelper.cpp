@@ -1,17 +1,104 @@
 /**
  * @class PixelHelper
  * @brief Static class to set and get a certain pixel from the given image.
+ * @details Every image inside the editor is kept in WORKING_FORMAT. Images are converted with toWorkingFormat()
+ * once when they enter the editor (opened files, masks, images received from the server, rendered scenes),
+ * so getPixel() and setPixel() can read scanlines as QRgb directly.
  */
 
 #include "PixelHelper.h"
 
 QRgb PixelHelper::getPixel(const QImage& image, int x, int y)
 {
+    Q_ASSERT(image.depth() == 32);
     return *(reinterpret_cast<const QRgb*>(image.scanLine(y)) + x);
 }
 
 void PixelHelper::setPixel(QImage& image, int x, int y, QRgb value)
 {
+    Q_ASSERT(image.depth() == 32);
     *(reinterpret_cast<QRgb*>(image.scanLine(y)) + x) = value;
 }
 
+/**
+ * @brief Converts an image to the canonical working format.
+ * @details Nothing is converted or copied if img already is in WORKING_FORMAT.
+ *
+ * @param img Image in any format, e.g. as chosen by the image decoder.
+ * @return QImage Image in WORKING_FORMAT.
+ */
+QImage PixelHelper::toWorkingFormat(const QImage& img)
+{
+    if (img.isNull() || img.format() == WORKING_FORMAT) {
+        return img;
+    }
+    return img.convertToFormat(WORKING_FORMAT);
+}
+
+/**
+ * @brief Checks whether every pixel of img is gray, i.e. red, green and blue are equal. Alpha is ignored.
+ *
+ * @param img Image in WORKING_FORMAT.
+ * @return true Image content is grayscale.
+ * @return false At least one pixel has color.
+ */
+bool PixelHelper::isGrayscale(const QImage& img)
+{
+    if (img.format() == QImage::Format_Grayscale8) {
+        return true;
+    }
+    for (int j = 0; j < img.height(); ++j) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(img.constScanLine(j));
+        for (int i = 0; i < img.width(); ++i) {
+            if (qRed(line[i]) != qGreen(line[i]) || qGreen(line[i]) != qBlue(line[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether every pixel of img is fully opaque.
+ *
+ * @param img Image in WORKING_FORMAT.
+ * @return true Every alpha is 255.
+ * @return false At least one pixel is (partly) transparent.
+ */
+bool PixelHelper::isOpaque(const QImage& img)
+{
+    if (!img.hasAlphaChannel()) {
+        return true;
+    }
+    for (int j = 0; j < img.height(); ++j) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(img.constScanLine(j));
+        for (int i = 0; i < img.width(); ++i) {
+            if (qAlpha(line[i]) != 255) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Packs a grayscale image into one byte per pixel.
+ *
+ * @param img Image in WORKING_FORMAT whose content is grayscale, see isGrayscale().
+ * @return QImage Format_Grayscale8 image holding the (equal) red, green and blue value of each pixel.
+ */
+QImage PixelHelper::toGrayscale8(const QImage& img)
+{
+    if (img.format() == QImage::Format_Grayscale8) {
+        return img;
+    }
+    QImage gray(img.size(), QImage::Format_Grayscale8);
+    for (int j = 0; j < img.height(); ++j) {
+        const QRgb* source = reinterpret_cast<const QRgb*>(img.constScanLine(j));
+        uchar* line = gray.scanLine(j);
+        for (int i = 0; i < img.width(); ++i) {
+            line[i] = static_cast<uchar>(qRed(source[i]));
+        }
+    }
+    return gray;
+}
@@ -10,6 +10,14 @@ public:
     PixelHelper() = delete;
     static QRgb getPixel(const QImage& img, int x, int y);
     static void setPixel(QImage& img, int x, int y, QRgb value);
+
+    static QImage toWorkingFormat(const QImage& img);
+    static bool isGrayscale(const QImage& img);
+    static bool isOpaque(const QImage& img);
+    static QImage toGrayscale8(const QImage& img);
+
+public:
+    static const QImage::Format WORKING_FORMAT = QImage::Format_ARGB32;    //!< Canonical format of every image inside the editor: 32-bit straight (non-premultiplied) ARGB.
 };
 
 #endif // PIXELHELPER_H
@@ -0,0 +1,79 @@
+/**
+ * @class SelectionOverlayItem
+ * @brief Translucent preview of a pixel selection, e.g. of the magic wand while its threshold is scrubbed.
+ * @details The overlay is allocated once. updatePixels() rewrites only the pixels that joined or left the selection
+ * and repaints only their bounding rectangle, so a small threshold step costs as much as the pixels it changes.
+ * paint() draws only the exposed part of the overlay.
+ */
+
+#include "SelectionOverlayItem.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+/**
+ * @brief Construct a new Selection Overlay Item:: Selection Overlay Item object, with nothing selected.
+ *
+ * @param size Size of the image the selection belongs to.
+ * @param color Color of selected pixels, not premultiplied.
+ * @param parent Passed to QGraphicsItem() constructor.
+ */
+SelectionOverlayItem::SelectionOverlayItem(const QSize &size, QRgb color, QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , overlay(size, QImage::Format_ARGB32_Premultiplied)
+    , selectedColor(qPremultiply(color))
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    overlay.fill(Qt::transparent);
+}
+
+/**
+ * @brief Copies the state of some pixels from selection, and repaints them.
+ *
+ * @param selection Selection with the size of the overlay.
+ * @param indices Pixels (y * width + x) that may have joined or left the selection.
+ * @return QRect Bounding rectangle of indices, in item coordinates.
+ */
+QRect SelectionOverlayItem::updatePixels(const BitMask &selection, const QVector<int> &indices)
+{
+    const int width = overlay.width();
+    int left = width, top = overlay.height(), right = -1, bottom = -1;
+    for (int index : indices) {
+        const int i = index % width, j = index / width;
+        reinterpret_cast<QRgb*>(overlay.scanLine(j))[i] = selection.testBit(i, j) ? selectedColor : 0;
+        left = qMin(left, i);
+        right = qMax(right, i);
+        top = qMin(top, j);
+        bottom = qMax(bottom, j);
+    }
+    if (right < 0) {
+        return QRect();
+    }
+    const QRect changed(QPoint(left, top), QPoint(right, bottom));
+    update(changed);
+    return changed;
+}
+
+/**
+ * @brief Bounding rectangle of the item, the whole image.
+ *
+ * @return QRectF Bounding rectangle in item coordinates.
+ */
+QRectF SelectionOverlayItem::boundingRect() const
+{
+    return QRectF(overlay.rect());
+}
+
+/**
+ * @brief Draws the exposed part of the overlay.
+ *
+ * @param painter Painter to draw with.
+ * @param option Style option, its exposedRect limits the pixels drawn.
+ */
+void SelectionOverlayItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    const QRect exposed = option->exposedRect.toAlignedRect().intersected(overlay.rect());
+    if (!exposed.isEmpty()) {
+        painter->drawImage(exposed, overlay, exposed);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef SELECTIONOVERLAYITEM_H
+#define SELECTIONOVERLAYITEM_H
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QVector>
+
+#include "BitMask.h"
+
+class SelectionOverlayItem : public QGraphicsItem
+{
+public:
+    SelectionOverlayItem(const QSize& size, QRgb color, QGraphicsItem* parent = nullptr);
+
+    QRect                       updatePixels(const BitMask& selection, const QVector<int>& indices);
+
+public:
+    virtual QRectF              boundingRect() const override;
+    virtual void                paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    QImage                      overlay;        //!< One pixel per image pixel, selectedColor where selected, transparent elsewhere.
+    QRgb                        selectedColor;  //!< Premultiplied color of selected pixels.
+};
+
+#endif // SELECTIONOVERLAYITEM_H
@@ -0,0 +1,120 @@
+/**
+ * @class StrokeItem
+ * @brief Freehand brush stroke, a polyline that is only appended to.
+ * @details A QGraphicsPathItem has to be handed a copy of its whole path for every new point, which makes a long stroke quadratic.
+ * Here append() is amortised constant time and returns the area of the new segment, so callers can repaint just that.
+ * The bounding rectangle grows with slack proportional to the stroke's size, so geometry changes, which repaint the whole item, stay rare.
+ * paint() only strokes the runs of segments near the exposed area, found through the bounds of chunks of CHUNK_SIZE segments.
+ * The caps and joins are round, so every run ends in a disc as the complete polyline would, and the runs cover the same area.
+ * All runs are stroked as one path, so where they overlap a translucent pen still blends each pixel once.
+ */
+
+#include "StrokeItem.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
+
+/**
+ * @brief Construct a new Stroke Item:: Stroke Item object
+ *
+ * @param pen Pen the stroke is drawn with, round caps and joins are expected.
+ * @param start First point of the stroke, in item coordinates.
+ * @param parent Passed to QGraphicsItem() constructor.
+ */
+StrokeItem::StrokeItem(const QPen &pen, const QPointF &start, QGraphicsItem *parent) : QGraphicsItem(parent), strokePen(pen)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    points.append(start);
+    strokeBounds = QRectF(start, start).adjusted(-margin(), -margin(), margin(), margin());
+    bounds = strokeBounds.adjusted(-MIN_GROWTH, -MIN_GROWTH, MIN_GROWTH, MIN_GROWTH);
+}
+
+/**
+ * @brief Appends a segment from the last point to point.
+ * @details Nothing is repainted, callers update() the returned area when the view should show it.
+ *
+ * @param point New last point, in item coordinates.
+ * @return QRectF Area covered by the new segment.
+ */
+QRectF StrokeItem::append(const QPointF &point)
+{
+    const QRectF segment = QRectF(points.last(), point).normalized().adjusted(-margin(), -margin(), margin(), margin());
+    points.append(point);
+    strokeBounds = strokeBounds.united(segment);
+    // Segment i joins points i - 1 and i, and belongs to chunk (i - 1) / CHUNK_SIZE
+    if ((points.size() - 2) / CHUNK_SIZE == chunkBounds.size())
+    {
+        chunkBounds.append(segment);
+    }
+    else
+    {
+        chunkBounds.last() = chunkBounds.last().united(segment);
+    }
+    if (!bounds.contains(segment))
+    {
+        prepareGeometryChange();
+        const qreal slack = qMax(static_cast<qreal>(MIN_GROWTH), qMax(strokeBounds.width(), strokeBounds.height()) / 2);
+        bounds = strokeBounds.adjusted(-slack, -slack, slack, slack);
+    }
+    return segment;
+}
+
+/**
+ * @brief Bounding rectangle of the item, contains the stroke and some slack.
+ *
+ * @return QRectF Bounding rectangle in item coordinates.
+ */
+QRectF StrokeItem::boundingRect() const
+{
+    return bounds;
+}
+
+/**
+ * @brief Strokes the segments that may touch the exposed area.
+ * @details Only chunks whose bounds intersect the exposed area are scanned segment by segment.
+ *
+ * @param painter Painter to draw with.
+ * @param option Style option, its exposedRect limits the segments drawn.
+ */
+void StrokeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    painter->setPen(strokePen);
+    painter->setBrush(Qt::NoBrush);
+    if (points.size() < 2)
+    {
+        return;
+    }
+
+    const QRectF exposed = option->exposedRect.adjusted(-margin(), -margin(), margin(), margin());
+    const auto isExposed = [&exposed](const QPointF &a, const QPointF &b) {
+        return qMin(a.x(), b.x()) <= exposed.right() && qMax(a.x(), b.x()) >= exposed.left() &&
+               qMin(a.y(), b.y()) <= exposed.bottom() && qMax(a.y(), b.y()) >= exposed.top();
+    };
+
+    // Every run of consecutive exposed segments becomes one subpath, all of them are stroked together
+    QPainterPath path;
+    int lastPoint = -1;
+    for (int chunk = 0; chunk < chunkBounds.size(); ++chunk)
+    {
+        if (!chunkBounds[chunk].intersects(option->exposedRect))
+        {
+            continue;
+        }
+        const int end = qMin(points.size(), (chunk + 1) * CHUNK_SIZE + 1);
+        for (int i = chunk * CHUNK_SIZE + 1; i < end; ++i)
+        {
+            if (!isExposed(points[i - 1], points[i]))
+            {
+                continue;
+            }
+            if (lastPoint != i - 1)
+            {
+                path.moveTo(points[i - 1]);
+            }
+            path.lineTo(points[i]);
+            lastPoint = i;
+        }
+    }
+    painter->drawPath(path);
+}
@@ -0,0 +1,40 @@
+#ifndef STROKEITEM_H
+#define STROKEITEM_H
+
+#include <QGraphicsItem>
+#include <QPen>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+class StrokeItem : public QGraphicsItem
+{
+public:
+    StrokeItem(const QPen& pen, const QPointF& start, QGraphicsItem* parent = nullptr);
+
+    QRectF                      append(const QPointF& point);
+
+public:
+    const QPen&                 pen() const { return strokePen; }                   //!< Pen the stroke is drawn with.
+    QRectF                      strokeRect() const { return strokeBounds; }         //!< Area actually covered by the stroke, boundingRect() may be larger.
+    int                         pointCount() const { return points.size(); }        //!< Number of points of the polyline.
+
+    virtual QRectF              boundingRect() const override;
+    virtual void                paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+public:
+    static constexpr qreal MIN_GROWTH = 64;     //!< Minimum slack added around the stroke whenever boundingRect() has to grow.
+    static const int CHUNK_SIZE = 32;           //!< Consecutive segments sharing one bounding rectangle, see paint().
+
+private:
+    qreal                       margin() const { return strokePen.widthF() / 2 + 1; }  //!< Distance the pen, including antialiasing, reaches beyond the polyline.
+
+private:
+    QPen                        strokePen;      //!< Pen the stroke is drawn with.
+    QVector<QPointF>            points;         //!< Polyline, only ever appended to.
+    QVector<QRectF>             chunkBounds;    //!< Bounds of every CHUNK_SIZE consecutive segments, grown by margin().
+    QRectF                      strokeBounds;   //!< Bounds of the polyline, grown by margin().
+    QRectF                      bounds;         //!< strokeBounds plus slack, so most appended segments do not change the geometry.
+};
+
+#endif // STROKEITEM_H
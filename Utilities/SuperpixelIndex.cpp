@@ -0,0 +1,381 @@
+/**
+ * @class SuperpixelIndex
+ * @brief Segmentation of an image into small, compact regions of similar color (SLIC superpixels).
+ * @details Built once per image, e.g. in the background after the image is opened, and reused by selections:
+ * a segment whose whole color range is within a threshold can be selected at once, only the other segments need per pixel work.
+ * Every segment is 4-connected, stored as runs (spans) and as the list of its border pixels.
+ */
+
+#include "SuperpixelIndex.h"
+#include "PixelHelper.h"
+
+#include <QtConcurrent>
+#include <QtMath>
+#include <limits>
+
+namespace {
+/**
+ * @brief Cluster center of SLIC, a color in Lab and a position.
+ */
+struct Center {
+    float l, a, b;
+    float x, y;
+};
+
+/**
+ * @brief Converts an sRGB channel (0..255) to linear light.
+ */
+float linearize(int value)
+{
+    const float c = value / 255.0f;
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+/**
+ * @brief Helper of the Lab conversion.
+ */
+float labCurve(float t)
+{
+    return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+}
+
+/**
+ * @brief Row band starts for a parallel map over the rows of an image.
+ */
+QVector<int> rowBands(int height, int rowsPerBand)
+{
+    QVector<int> bands((height + rowsPerBand - 1) / rowsPerBand);
+    for (int i = 0; i < bands.size(); ++i) {
+        bands[i] = i * rowsPerBand;
+    }
+    return bands;
+}
+}
+
+/**
+ * @brief Segments image with SLIC.
+ * @details Pixels are compared in Lab. Assignment looks at the centers of the 3x3 grid cells around a pixel,
+ * so row bands are assigned in parallel, and every grid row of centers is updated in parallel from the rows it can own.
+ * The result does not depend on thread scheduling.
+ *
+ * @param image Image to segment.
+ * @param segmentSize Grid step, segments cover roughly segmentSize x segmentSize pixels.
+ * @return SuperpixelIndex Index of image, null if image is null.
+ */
+SuperpixelIndex SuperpixelIndex::build(const QImage &image, int segmentSize)
+{
+    SuperpixelIndex index;
+    if (image.isNull() || segmentSize < 2) {
+        return index;
+    }
+    const QImage working = PixelHelper::toWorkingFormat(image);
+    const int width = working.width(), height = working.height();
+    index.imageKey = image.cacheKey();
+    index.imageWidth = width;
+    index.imageHeight = height;
+
+    // Lab image, row bands in parallel
+    static const QVector<float> linear = [] {
+        QVector<float> table(256);
+        for (int i = 0; i < 256; ++i) {
+            table[i] = linearize(i);
+        }
+        return table;
+    }();
+    QVector<float> lab(width * height * 3);
+    float* labData = lab.data();
+    QVector<int> bands = rowBands(height, ROWS_PER_BAND);
+    QtConcurrent::blockingMap(bands, [&](int firstRow) {
+        for (int j = firstRow; j < qMin(firstRow + ROWS_PER_BAND, height); ++j) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(working.constScanLine(j));
+            float* out = labData + j * width * 3;
+            for (int i = 0; i < width; ++i) {
+                const float r = linear[qRed(line[i])], g = linear[qGreen(line[i])], b = linear[qBlue(line[i])];
+                const float fx = labCurve((0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f);
+                const float fy = labCurve(0.2126f * r + 0.7152f * g + 0.0722f * b);
+                const float fz = labCurve((0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f);
+                out[i * 3] = 116.0f * fy - 16.0f;
+                out[i * 3 + 1] = 500.0f * (fx - fy);
+                out[i * 3 + 2] = 200.0f * (fy - fz);
+            }
+        }
+    });
+
+    // One center per grid cell
+    const int columns = (width + segmentSize - 1) / segmentSize;
+    const int rows = (height + segmentSize - 1) / segmentSize;
+    QVector<Center> centers(columns * rows);
+    for (int cy = 0; cy < rows; ++cy) {
+        for (int cx = 0; cx < columns; ++cx) {
+            const int x = qMin(cx * segmentSize + segmentSize / 2, width - 1);
+            const int y = qMin(cy * segmentSize + segmentSize / 2, height - 1);
+            const float* pixel = lab.constData() + (y * width + x) * 3;
+            centers[cy * columns + cx] = Center{pixel[0], pixel[1], pixel[2], float(x), float(y)};
+        }
+    }
+
+    const float spatialWeight = float(COMPACTNESS * COMPACTNESS) / float(segmentSize * segmentSize);
+    index.labels = QVector<int>(width * height);
+    int* labels = index.labels.data();
+    Center* centerData = centers.data();
+    QVector<int> centerRows(rows);
+    for (int cy = 0; cy < rows; ++cy) {
+        centerRows[cy] = cy;
+    }
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        // Assignment: every pixel picks the closest of the centers around its grid cell
+        QtConcurrent::blockingMap(bands, [&](int firstRow) {
+            for (int j = firstRow; j < qMin(firstRow + ROWS_PER_BAND, height); ++j) {
+                const int cy = j / segmentSize;
+                for (int i = 0; i < width; ++i) {
+                    const int cx = i / segmentSize;
+                    const float* pixel = lab.constData() + (j * width + i) * 3;
+                    float best = std::numeric_limits<float>::max();
+                    int bestLabel = cy * columns + cx;
+                    for (int ny = qMax(cy - 1, 0); ny <= qMin(cy + 1, rows - 1); ++ny) {
+                        for (int nx = qMax(cx - 1, 0); nx <= qMin(cx + 1, columns - 1); ++nx) {
+                            const Center& center = centerData[ny * columns + nx];
+                            const float dl = pixel[0] - center.l, da = pixel[1] - center.a, db = pixel[2] - center.b;
+                            const float dx = i - center.x, dy = j - center.y;
+                            const float distance = dl * dl + da * da + db * db + spatialWeight * (dx * dx + dy * dy);
+                            if (distance < best) {
+                                best = distance;
+                                bestLabel = ny * columns + nx;
+                            }
+                        }
+                    }
+                    labels[j * width + i] = bestLabel;
+                }
+            }
+        });
+
+        // Update: a center of grid row cy only owns pixels of grid rows cy - 1 .. cy + 1
+        QtConcurrent::blockingMap(centerRows, [&](int cy) {
+            QVector<double> sums(columns * 5, 0.0);
+            QVector<int> counts(columns, 0);
+            const int firstRow = qMax(cy - 1, 0) * segmentSize, lastRow = qMin((cy + 2) * segmentSize, height);
+            for (int j = firstRow; j < lastRow; ++j) {
+                for (int i = 0; i < width; ++i) {
+                    const int label = labels[j * width + i];
+                    if (label / columns != cy) {
+                        continue;
+                    }
+                    const int cx = label % columns;
+                    const float* pixel = lab.constData() + (j * width + i) * 3;
+                    sums[cx * 5] += pixel[0];
+                    sums[cx * 5 + 1] += pixel[1];
+                    sums[cx * 5 + 2] += pixel[2];
+                    sums[cx * 5 + 3] += i;
+                    sums[cx * 5 + 4] += j;
+                    ++counts[cx];
+                }
+            }
+            for (int cx = 0; cx < columns; ++cx) {
+                if (counts[cx] > 0) {
+                    const double* sum = sums.constData() + cx * 5;
+                    centerData[cy * columns + cx] = Center{float(sum[0] / counts[cx]), float(sum[1] / counts[cx]), float(sum[2] / counts[cx]),
+                                                           float(sum[3] / counts[cx]), float(sum[4] / counts[cx])};
+                }
+            }
+        });
+    }
+
+    index.enforceConnectivity(segmentSize);
+    index.buildSegments(working);
+    return index;
+}
+
+/**
+ * @brief Checks whether the index belongs to image.
+ * @details Image versions are told apart by QImage::cacheKey(), which changes whenever the pixels change,
+ * so no pixels are compared and the index does not keep the image alive.
+ *
+ * @param image Image to check.
+ * @return true The index was built from this version of image.
+ * @return false The index is null or image differs.
+ */
+bool SuperpixelIndex::isBuiltFrom(const QImage &image) const
+{
+    return !isNull() && imageKey == image.cacheKey() && imageWidth == image.width() && imageHeight == image.height();
+}
+
+/**
+ * @brief Gets the index of image, a version of the indexed image with the removed pixels made transparent, e.g. by a magic wand crop.
+ * @details Removing pixels keeps every segment 4-connected, only the segments that lost pixels are flagged,
+ * so they are no longer selected at once. Labels, runs and border pixels are shared with this index.
+ *
+ * @param image Image after the removal.
+ * @param removed Pixels that were made transparent.
+ * @return SuperpixelIndex Index of image.
+ */
+SuperpixelIndex SuperpixelIndex::afterRemoving(const QImage &image, const BitMask &removed) const
+{
+    SuperpixelIndex index = *this;
+    index.imageKey = image.cacheKey();
+    removed.forEachSetBit([this, &index](int x, int y) {
+        index.segments[label(x, y)].hasRemovedPixels = true;
+    });
+    return index;
+}
+
+/**
+ * @brief Checks whether every pixel of a segment is within threshold of color, without visiting the pixels.
+ *
+ * @param label Segment.
+ * @param color Color to compare with.
+ * @param threshold Largest allowed difference per channel.
+ * @return true Every pixel of the segment is within threshold of color.
+ * @return false Some pixel may not be, or the segment contains removed pixels.
+ */
+bool SuperpixelIndex::isWithinThreshold(int label, QRgb color, int threshold) const
+{
+    const Segment& range = segments[label];
+    if (range.hasRemovedPixels) {
+        return false;
+    }
+    const int channels[3] = {qRed(color), qGreen(color), qBlue(color)};
+    for (int c = 0; c < 3; ++c) {
+        if (range.maximum[c] - channels[c] > threshold || channels[c] - range.minimum[c] > threshold) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sets every pixel of a segment in mask, a run at a time.
+ *
+ * @param label Segment.
+ * @param mask Mask with the size of the image.
+ */
+void SuperpixelIndex::fillSegment(int label, BitMask &mask) const
+{
+    for (int k = spanOffsets[label]; k < spanOffsets[label + 1]; ++k) {
+        mask.setSpan(spans[k].y, spans[k].left, spans[k].right);
+    }
+}
+
+/**
+ * @brief Relabels the segments so that every segment is 4-connected.
+ * @details SLIC labels can be split into several pieces. Every piece becomes its own segment,
+ * pieces smaller than a quarter of a grid cell are merged into the segment before them in row-major order, which touches them.
+ *
+ * @param segmentSize Grid step the labels were computed with.
+ */
+void SuperpixelIndex::enforceConnectivity(int segmentSize)
+{
+    const int minimumSize = qMax(1, segmentSize * segmentSize / 4);
+    QVector<int> relabelled(labels.size(), -1);
+    QVector<int> component;
+    int next = 0;
+    for (int start = 0; start < labels.size(); ++start) {
+        if (relabelled[start] >= 0) {
+            continue;
+        }
+        // Segment of the left or upper neighbour, both are already labelled
+        const int x = start % imageWidth, y = start / imageWidth;
+        int adjacent = -1;
+        if (x > 0) {
+            adjacent = relabelled[start - 1];
+        }
+        else if (y > 0) {
+            adjacent = relabelled[start - imageWidth];
+        }
+
+        component.clear();
+        component.append(start);
+        relabelled[start] = next;
+        for (int k = 0; k < component.size(); ++k) {
+            const int i = component[k] % imageWidth, j = component[k] / imageWidth;
+            const int neighbours[4][2] = {{i + 1, j}, {i - 1, j}, {i, j + 1}, {i, j - 1}};
+            for (const auto& neighbour : neighbours) {
+                if (neighbour[0] < 0 || neighbour[0] >= imageWidth || neighbour[1] < 0 || neighbour[1] >= imageHeight) {
+                    continue;
+                }
+                const int n = neighbour[1] * imageWidth + neighbour[0];
+                if (relabelled[n] < 0 && labels[n] == labels[start]) {
+                    relabelled[n] = next;
+                    component.append(n);
+                }
+            }
+        }
+
+        if (component.size() < minimumSize && adjacent >= 0) {
+            for (int pixel : component) {
+                relabelled[pixel] = adjacent;
+            }
+        }
+        else {
+            ++next;
+        }
+    }
+    labels = relabelled;
+    segments = QVector<Segment>(next);
+}
+
+/**
+ * @brief Computes the color range, the runs and the border pixels of every segment.
+ *
+ * @param working Image the index is built from, in PixelHelper::WORKING_FORMAT.
+ */
+void SuperpixelIndex::buildSegments(const QImage &working)
+{
+    QVector<int> spanCounts(segments.size() + 1, 0);
+    QVector<int> borderCounts(segments.size() + 1, 0);
+
+    auto isBorder = [this](int i, int j) {
+        const int label = labels[j * imageWidth + i];
+        return (i > 0 && labels[j * imageWidth + i - 1] != label)
+                || (i + 1 < imageWidth && labels[j * imageWidth + i + 1] != label)
+                || (j > 0 && labels[(j - 1) * imageWidth + i] != label)
+                || (j + 1 < imageHeight && labels[(j + 1) * imageWidth + i] != label);
+    };
+
+    // Count runs and border pixels, collect the color ranges
+    for (int j = 0; j < imageHeight; ++j) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(working.constScanLine(j));
+        for (int i = 0; i < imageWidth; ++i) {
+            const int label = labels[j * imageWidth + i];
+            Segment& range = segments[label];
+            const int channels[3] = {qRed(line[i]), qGreen(line[i]), qBlue(line[i])};
+            for (int c = 0; c < 3; ++c) {
+                range.minimum[c] = static_cast<uchar>(qMin<int>(range.minimum[c], channels[c]));
+                range.maximum[c] = static_cast<uchar>(qMax<int>(range.maximum[c], channels[c]));
+            }
+            if (line[i] == Qt::transparent) {
+                range.hasRemovedPixels = true;
+            }
+            if (i == 0 || labels[j * imageWidth + i - 1] != label) {
+                ++spanCounts[label + 1];
+            }
+            if (isBorder(i, j)) {
+                ++borderCounts[label + 1];
+            }
+        }
+    }
+    for (int s = 0; s < segments.size(); ++s) {
+        spanCounts[s + 1] += spanCounts[s];
+        borderCounts[s + 1] += borderCounts[s];
+    }
+    spanOffsets = spanCounts;
+    borderOffsets = borderCounts;
+    spans = QVector<Span>(spanOffsets.last());
+    borderPixels = QVector<int>(borderOffsets.last());
+
+    // Fill both lists, spanCounts and borderCounts become the write positions
+    for (int j = 0; j < imageHeight; ++j) {
+        for (int i = 0; i < imageWidth; ++i) {
+            const int label = labels[j * imageWidth + i];
+            if (i == 0 || labels[j * imageWidth + i - 1] != label) {
+                int right = i;
+                while (right + 1 < imageWidth && labels[j * imageWidth + right + 1] == label) {
+                    ++right;
+                }
+                spans[spanCounts[label]++] = Span{j, i, right};
+            }
+            if (isBorder(i, j)) {
+                borderPixels[borderCounts[label]++] = j * imageWidth + i;
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef SUPERPIXELINDEX_H
+#define SUPERPIXELINDEX_H
+
+#include <QImage>
+#include <QVector>
+#include <QRgb>
+
+#include "BitMask.h"
+
+class SuperpixelIndex
+{
+public:
+    /**
+     * @brief A horizontal run of pixels of one segment.
+     */
+    struct Span {
+        int y;          //!< Row of the run.
+        int left;       //!< First pixel of the run.
+        int right;      //!< Last pixel of the run, inclusive.
+    };
+
+    /**
+     * @brief Color range of a segment, to decide whether all of it is within a threshold without visiting its pixels.
+     */
+    struct Segment {
+        uchar minimum[3] = {255, 255, 255};     //!< Smallest red, green and blue of the segment.
+        uchar maximum[3] = {0, 0, 0};           //!< Largest red, green and blue of the segment.
+        bool hasRemovedPixels = false;          //!< True if the segment contains removed (transparent) pixels.
+    };
+
+public:
+    SuperpixelIndex() = default;
+    static SuperpixelIndex build(const QImage& image, int segmentSize = SEGMENT_SIZE);
+
+public:
+    bool                        isNull() const { return labels.isEmpty(); }                     //!< True if no index is built.
+    bool                        isBuiltFrom(const QImage& image) const;
+    SuperpixelIndex             afterRemoving(const QImage& image, const BitMask& removed) const;
+    int                         segmentCount() const { return segments.size(); }                //!< Number of segments.
+    int                         label(int x, int y) const { return labels[y * imageWidth + x]; }  //!< Segment of the (x,y) pixel.
+    const Segment&              segment(int label) const { return segments[label]; }            //!< Color range of a segment.
+    bool                        isWithinThreshold(int label, QRgb color, int threshold) const;
+    void                        fillSegment(int label, BitMask& mask) const;
+
+    template <typename Function>
+    void                        forEachPixel(int label, Function function) const;
+    template <typename Function>
+    void                        forEachBorderPixel(int label, Function function) const;
+
+public:
+    static const int SEGMENT_SIZE = 16;         //!< Default grid step, segments cover roughly SEGMENT_SIZE x SEGMENT_SIZE pixels.
+    static const int ITERATIONS = 5;            //!< Assignment/update rounds of SLIC.
+    static const int COMPACTNESS = 10;          //!< Weight of the spatial distance against the Lab color distance.
+    static const int ROWS_PER_BAND = 64;        //!< Rows processed by one task.
+
+private:
+    void                        enforceConnectivity(int segmentSize);
+    void                        buildSegments(const QImage& working);
+
+private:
+    qint64                      imageKey = 0;           //!< QImage::cacheKey() of the image the index was built from.
+    int                         imageWidth = 0;         //!< Width of image.
+    int                         imageHeight = 0;        //!< Height of image.
+    QVector<int>                labels;                 //!< Per pixel, the segment it belongs to. Every segment is 4-connected.
+    QVector<Segment>            segments;               //!< Color range of every segment.
+    QVector<int>                spanOffsets;            //!< spans[spanOffsets[s] .. spanOffsets[s + 1]) are the runs of segment s.
+    QVector<Span>               spans;                  //!< Runs of all segments, grouped by segment.
+    QVector<int>                borderOffsets;          //!< borderPixels[borderOffsets[s] .. borderOffsets[s + 1]) are the border pixels of segment s.
+    QVector<int>                borderPixels;           //!< Pixel indices with a 4-neighbour in another segment, grouped by segment.
+};
+
+/**
+ * @brief Calls function(x, y) for every pixel of the segment, run by run.
+ *
+ * @param label Segment.
+ * @param function Called with the position of every pixel.
+ */
+template <typename Function>
+void SuperpixelIndex::forEachPixel(int label, Function function) const
+{
+    for (int k = spanOffsets[label]; k < spanOffsets[label + 1]; ++k) {
+        for (int x = spans[k].left; x <= spans[k].right; ++x) {
+            function(x, spans[k].y);
+        }
+    }
+}
+
+/**
+ * @brief Calls function(x, y) for every pixel of the segment that has a 4-neighbour in another segment.
+ * @details Every way out of a segment starts at one of these pixels.
+ *
+ * @param label Segment.
+ * @param function Called with the position of every border pixel.
+ */
+template <typename Function>
+void SuperpixelIndex::forEachBorderPixel(int label, Function function) const
+{
+    for (int k = borderOffsets[label]; k < borderOffsets[label + 1]; ++k) {
+        function(borderPixels[k] % imageWidth, borderPixels[k] / imageWidth);
+    }
+}
+
+#endif // SUPERPIXELINDEX_H
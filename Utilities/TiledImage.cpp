@@ -0,0 +1,178 @@
+/**
+ * @class TiledImage
+ * @brief Image stored as a grid of TILE_SIZE x TILE_SIZE tiles.
+ * @details Every tile is its own implicitly shared QImage, so copying a TiledImage only copies references,
+ * and two versions of an image, e.g. consecutive commits in the VersionControl, can share all tiles that an edit did not touch.
+ */
+
+#include "TiledImage.h"
+#include "ImageBufferPool.h"
+
+#include <cstring>
+
+namespace {
+/**
+ * @brief Compares the pixels of rect in image with the pixels of tile.
+ *
+ * @param image Whole image.
+ * @param rect Region of the image covered by tile.
+ * @param tile Tile to compare with.
+ * @return true Pixels are byte-for-byte identical.
+ * @return false Pixels differ, or the tile cannot be compared.
+ */
+bool regionEqualsTile(const QImage& image, const QRect& rect, const QImage& tile)
+{
+    if (tile.size() != rect.size() || tile.format() != image.format() || image.depth() % 8 != 0) {
+        return false;
+    }
+    const int bytesPerPixel = image.depth() / 8;
+    const size_t lineBytes = static_cast<size_t>(rect.width() * bytesPerPixel);
+    for (int y = 0; y < rect.height(); ++y) {
+        const uchar* imageLine = image.constScanLine(rect.top() + y) + rect.left() * bytesPerPixel;
+        if (std::memcmp(imageLine, tile.constScanLine(y), lineBytes) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+/**
+ * @brief Construct a new, null, Tiled Image:: Tiled Image object
+ */
+TiledImage::TiledImage()
+{
+}
+
+/**
+ * @brief Construct a new Tiled Image:: Tiled Image object by splitting image into tiles.
+ *
+ * @param image Image to split.
+ */
+TiledImage::TiledImage(const QImage& image) : TiledImage(image, TiledImage())
+{
+}
+
+/**
+ * @brief Construct a new Tiled Image:: Tiled Image object, sharing unchanged tiles with a previous version.
+ * @details A tile whose pixels are identical to the tile at the same position in previous is not copied,
+ * instead it references the previous tile's pixel data.
+ *
+ * @param image Image to split.
+ * @param previous Previous version of the image, may be null.
+ */
+TiledImage::TiledImage(const QImage& image, const TiledImage& previous)
+    : imageWidth(image.width())
+    , imageHeight(image.height())
+    , columns((image.width() + TILE_SIZE - 1) / TILE_SIZE)
+    , rows((image.height() + TILE_SIZE - 1) / TILE_SIZE)
+    , imageFormat(image.format())
+    , sourceKey(image.cacheKey())
+{
+    if (image.isNull()) {
+        columns = rows = 0;
+        return;
+    }
+    // The image was not written to since previous was split from it, every tile can be shared without comparing pixels
+    if (!previous.isNull() && previous.sourceKey == sourceKey && previous.size() == size()) {
+        tiles = previous.tiles;
+        return;
+    }
+    const bool comparable = previous.size() == size() && previous.format() == format();
+    tiles.reserve(columns * rows);
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            QRect rect = tileRect(column, row);
+            if (comparable && regionEqualsTile(image, rect, previous.tile(column, row))) {
+                tiles.append(previous.tile(column, row));
+            }
+            else {
+                tiles.append(image.copy(rect));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Gets the region of the whole image covered by a tile.
+ *
+ * @param column Tile column.
+ * @param row Tile row.
+ * @return QRect Region in image coordinates. Edge tiles are clipped to the image.
+ */
+QRect TiledImage::tileRect(int column, int row) const
+{
+    return QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE).intersected(QRect(0, 0, imageWidth, imageHeight));
+}
+
+/**
+ * @brief Gets a read-only tile.
+ *
+ * @param column Tile column.
+ * @param row Tile row.
+ * @return const QImage& Tile at column, row.
+ */
+const QImage& TiledImage::tile(int column, int row) const
+{
+    return tiles[row * columns + column];
+}
+
+/**
+ * @brief Lists the tiles touched by a region.
+ *
+ * @param rect Region in image coordinates.
+ * @return QVector<QPoint> Column (x) and row (y) of every intersecting tile.
+ */
+QVector<QPoint> TiledImage::tilesIntersecting(const QRect& rect) const
+{
+    QVector<QPoint> result;
+    QRect clipped = rect.intersected(QRect(0, 0, imageWidth, imageHeight));
+    if (clipped.isEmpty()) {
+        return result;
+    }
+    for (int row = clipped.top() / TILE_SIZE; row <= clipped.bottom() / TILE_SIZE; ++row) {
+        for (int column = clipped.left() / TILE_SIZE; column <= clipped.right() / TILE_SIZE; ++column) {
+            result.append(QPoint(column, row));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Assembles the tiles into one image.
+ *
+ * @return QImage Whole image.
+ */
+QImage TiledImage::toImage() const
+{
+    return copy(QRect(0, 0, imageWidth, imageHeight));
+}
+
+/**
+ * @brief Assembles a region of the image, touching only the tiles it intersects.
+ *
+ * @param rect Region in image coordinates.
+ * @return QImage Pixels of rect, clipped to the image.
+ */
+QImage TiledImage::copy(const QRect& rect) const
+{
+    QRect clipped = rect.intersected(QRect(0, 0, imageWidth, imageHeight));
+    if (isNull() || clipped.isEmpty()) {
+        return QImage();
+    }
+    QImage result = ImageBufferPool::acquire(clipped.size(), imageFormat);
+    result.setColorTable(tiles.first().colorTable());
+    const int bytesPerPixel = result.depth() / 8;
+    for (const QPoint& position : tilesIntersecting(clipped)) {
+        QRect source = tileRect(position.x(), position.y());
+        QRect overlap = source.intersected(clipped);
+        const QImage& current = tile(position.x(), position.y());
+        const size_t lineBytes = static_cast<size_t>(overlap.width() * bytesPerPixel);
+        for (int y = overlap.top(); y <= overlap.bottom(); ++y) {
+            const uchar* from = current.constScanLine(y - source.top()) + (overlap.left() - source.left()) * bytesPerPixel;
+            uchar* to = result.scanLine(y - clipped.top()) + (overlap.left() - clipped.left()) * bytesPerPixel;
+            std::memcpy(to, from, lineBytes);
+        }
+    }
+    return result;
+}
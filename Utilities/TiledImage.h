@@ -0,0 +1,46 @@
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+
+#include <QImage>
+#include <QVector>
+#include <QRect>
+#include <QPoint>
+
+class TiledImage
+{
+public:
+    TiledImage();
+    explicit TiledImage(const QImage& image);
+    TiledImage(const QImage& image, const TiledImage& previous);
+
+public:
+    int                         width() const { return imageWidth; }                                //!< Image width in pixels.
+    int                         height() const { return imageHeight; }                              //!< Image height in pixels.
+    QSize                       size() const { return QSize(imageWidth, imageHeight); }             //!< Image size in pixels.
+    bool                        isNull() const { return tiles.isEmpty(); }                          //!< True if no image is stored.
+    QImage::Format              format() const { return imageFormat; }                              //!< Pixel format of every tile.
+    int                         tileColumns() const { return columns; }                             //!< Number of tiles in x direction.
+    int                         tileRows() const { return rows; }                                   //!< Number of tiles in y direction.
+    int                         tileCount() const { return tiles.size(); }                          //!< Total number of tiles.
+
+    QRect                       tileRect(int column, int row) const;
+    const QImage&               tile(int column, int row) const;
+    QVector<QPoint>             tilesIntersecting(const QRect& rect) const;
+
+    QImage                      toImage() const;
+    QImage                      copy(const QRect& rect) const;
+
+public:
+    static const int TILE_SIZE = 256;      //!< Width and height of a full tile, edge tiles may be smaller.
+
+private:
+    int                         imageWidth = 0;                         //!< Width of the whole image.
+    int                         imageHeight = 0;                        //!< Height of the whole image.
+    int                         columns = 0;                            //!< Tiles per row.
+    int                         rows = 0;                               //!< Tiles per column.
+    QImage::Format              imageFormat = QImage::Format_Invalid;   //!< Format shared by all tiles.
+    qint64                      sourceKey = 0;                          //!< cacheKey() of the image the tiles were split from.
+    QVector<QImage>             tiles;                                  //!< Row-major tiles, each implicitly shared (copy-on-write).
+};
+
+#endif // TILEDIMAGE_H
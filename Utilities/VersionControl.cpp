@@ -34,16 +34,31 @@ VersionControl::VersionControl()
     masterBranchLength = 0;
 }
 
+/**
+ * @brief Gets the image contained in the node.
+ * @details The tiles are assembled at most once, later reads return the cached image.
+ * 
+ * @return QImage Image contained in the node.
+ */
+QImage VersionControl::SideNode::currentImage() const
+{
+    if (image.isNull()) {
+        image = currentTiles.toImage();
+    }
+    return image;
+}
+
 /**
  * @brief Construct a new Version Control:: Master Node:: Master Node object
  * 
  * @param image Commits image to the sideBranch of the master node.
  * @param changes Commit message.
+ * @param previous Previous version of the image, unchanged tiles are shared with it.
  */
-VersionControl::MasterNode::MasterNode(QImage image, QString changes)
+VersionControl::MasterNode::MasterNode(QImage image, QString changes, const TiledImage& previous)
     : changes(changes), sideBranchLength(1)
 {
-    sideBranch.push_front(SideNode(image, changes));
+    sideBranch.push_front(SideNode(image, changes, previous));
 }
 
 /**
@@ -54,15 +69,19 @@ VersionControl::MasterNode::MasterNode(QImage image, QString changes)
  */
 void VersionControl::MasterNode::commitChanges(QImage image, QString changes)
 {   
+    // Share the tiles this commit did not touch with the latest commit.
+    SideNode node(image, changes, getLatestTiles());
+    // Only the latest commit keeps its whole image, older ones are assembled from their tiles when checked out.
+    sideBranch.first().releaseImage();
     // No need to pop back commit, if length is still below maximum length.
     if (sideBranchLength + 1 <= maxSideBranchLength) {
-        sideBranch.push_front(SideNode(image, changes));
+        sideBranch.push_front(node);
         ++sideBranchLength;
     }
     // Needs to remove the oldest commit.
     else {
         sideBranch.pop_back();
-        sideBranch.push_front(SideNode(image, changes));
+        sideBranch.push_front(node);
     }
 }
 
@@ -78,15 +97,15 @@ void VersionControl::MasterNode::reverseCommit()
 }
 
 /**
- * @brief Gets const QImage& from index of a side branch.
+ * @brief Gets QImage from index of a side branch.
  * 
  * @param index
- * @return const QImage& returned image at index.
+ * @return QImage returned image at index.
  */
-const QImage& VersionControl::MasterNode::getImageAtIndex(int index)
+QImage VersionControl::MasterNode::getImageAtIndex(int index)
 {
     QLinkedList<SideNode>::iterator it = sideBranch.begin() + index;
-    return it->currentImage;
+    return it->currentImage();
 }
 
 /**
@@ -97,15 +116,20 @@ const QImage& VersionControl::MasterNode::getImageAtIndex(int index)
  */
 void VersionControl::commitChanges(QImage image, QString changes)
 {
+    // Share the tiles this commit did not touch with the latest commit.
+    MasterNode node(image, changes, masterBranch.isEmpty() ? TiledImage() : masterBranch.first().getLatestTiles());
+    if (!masterBranch.isEmpty()) {
+        masterBranch.first().sideBranch.first().releaseImage();
+    }
     // No need to pop back commit, if length is still below maximum length.
     if (masterBranchLength + 1 <= maxMasterBranchLength) {
-        masterBranch.push_front(MasterNode(image, changes));
+        masterBranch.push_front(node);
         ++masterBranchLength;
     }
     // Needs to remove the oldest commit.
     else {
         masterBranch.pop_back();
-        masterBranch.push_front(MasterNode(image, changes));
+        masterBranch.push_front(node);
     }
 }
 
@@ -121,12 +145,12 @@ void VersionControl::reverseCommit()
 }
 
 /**
- * @brief Gets const QImage& from index of master branch.
+ * @brief Gets QImage from index of master branch.
  * 
  * @param index 
- * @return const QImage& returned image at index.
+ * @return QImage returned image at index.
  */
-const QImage& VersionControl::getImageAtIndex(int index)
+QImage VersionControl::getImageAtIndex(int index)
 {
     return getMasterNodeIteratorAtIndex(index)->getImageAtIndex(0);
 }
@@ -3,6 +3,7 @@
 
 #include <QLinkedList>
 #include <QImage>
+#include "TiledImage.h"
 
 class VersionControl
 {
@@ -17,10 +18,14 @@ private:
          * 
          * @param image Image to be contained in the node.
          * @param changes Commit message.
+         * @param previous Previous version, tiles left unchanged by this commit are shared with it.
          */
-        SideNode(QImage image, QString changes) : currentImage(image), changes(changes) {}
-        QImage currentImage;    //!< Image contained in the node.
-        QString changes;        //!< Commit message.
+        SideNode(QImage image, QString changes, const TiledImage& previous = TiledImage()) : currentTiles(image, previous), image(image), changes(changes) {}
+        QImage currentImage() const;
+        void releaseImage() const { image = QImage(); }                 //!< Drops the assembled image, the tiles still hold the pixels.
+        TiledImage currentTiles;    //!< Image contained in the node, stored as copy-on-write tiles.
+        mutable QImage image;       //!< Assembled image, null until read again once the node is no longer the latest commit.
+        QString changes;            //!< Commit message.
     };
 
     /**
@@ -35,7 +40,7 @@ private:
         int                             sideBranchLength;   // Side branch length.
 
     public:
-        MasterNode(QImage, QString);    //!< MasterNode constructor
+        MasterNode(QImage, QString, const TiledImage& previous = TiledImage());    //!< MasterNode constructor
         MasterNode(SideNode);           //!< Overloaded MasterNode constructor
 
     public:
@@ -43,7 +48,8 @@ private:
         QString                         getName() const { return changes; }
         void                            commitChanges(QImage, QString);
         void                            reverseCommit();
-        const QImage&                   getImageAtIndex(int index);
+        QImage                          getImageAtIndex(int index);
+        const TiledImage&               getLatestTiles() const { return sideBranch.first().currentTiles; }
         bool                            canReverseCommit() const { return sideBranchLength > 1; }
     };
 
@@ -54,7 +60,7 @@ public:
     int                                 getBranchLength() const { return masterBranchLength; }
     void                                commitChanges(QImage, QString);
     void                                reverseCommit();
-    const QImage&                       getImageAtIndex(int index);
+    QImage                              getImageAtIndex(int index);
     QLinkedList<MasterNode>::iterator   getMasterNodeIteratorAtIndex(int index);
     bool                                canReverseCommit() const { return masterBranchLength > 1; }
 
@@ -7,9 +7,11 @@
 
 #include "WorkspaceArea.h"
 #include "Utilities/PixelHelper.h"
+#include "Utilities/ImageBufferPool.h"
 #include "FilterTransform/NonKernelBased/MagicWand.h"
 
 #include <QtWidgets>
+#include <QtConcurrent>
 #if defined(QT_PRINTSUPPORT_LIB)
 #include <QtPrintSupport/qtprintsupportglobal.h>
 #if QT_CONFIG(printdialog)
@@ -34,6 +36,8 @@ WorkspaceArea::WorkspaceArea(QObject *parent)
 	myPenColor = Qt::blue;
 	pen.setCapStyle(Qt::RoundCap);
 	pen.setJoinStyle(Qt::RoundJoin);
+	strokeUpdateTimer.setSingleShot(true);
+	connect(&strokeUpdateTimer, &QTimer::timeout, this, &WorkspaceArea::flushStrokeUpdate);
 }
 
 /**
@@ -56,6 +60,8 @@ WorkspaceArea::WorkspaceArea(int width, int height, QObject *parent)
 	myPenColor = Qt::blue;
 	pen.setCapStyle(Qt::RoundCap);
 	pen.setJoinStyle(Qt::RoundJoin);
+	strokeUpdateTimer.setSingleShot(true);
+	connect(&strokeUpdateTimer, &QTimer::timeout, this, &WorkspaceArea::flushStrokeUpdate);
 }
 
 /**
@@ -67,7 +73,20 @@ WorkspaceArea::WorkspaceArea(int width, int height, QObject *parent)
  */
 void WorkspaceArea::openImage(const QImage &loadedImage, int imageWidth, int imageHeight)
 {
-    image = loadedImage.copy();
+    image = PixelHelper::toWorkingFormat(loadedImage);
+	// Buffers pooled for another image size would never be acquired again
+	ImageBufferPool::trim(image.size());
+	// Component labels of another image would never be used again
+	if (!magicWand.hasComponentIndex(image))
+	{
+		magicWand.releaseComponentIndex();
+	}
+	// Likewise segments of another image, unless they are being built for this one
+	const QSharedPointer<const SuperpixelIndex> index = magicWand.getSuperpixelIndex();
+	if (!(index && index->isBuiltFrom(image)) && superpixelKey != image.cacheKey())
+	{
+		clearSuperpixelIndex();
+	}
 	isImageLoaded = true;
 	this->imageWidth = imageWidth;
 	this->imageHeight = imageHeight;
@@ -85,26 +104,143 @@ void WorkspaceArea::openImage(const QImage &loadedImage, int imageWidth, int ima
 	pixmapGraphics->setPos({imageWidth / 2.0 - scaledImage.width() / 2.0, imageHeight / 2.0 - scaledImage.height() / 2.0});
 	pixmapGraphics->setZValue(-2000);
 
+	// An opaque image that fills the scene one to one already is the flattened scene, rendering it would only give an equal copy.
+	// Committing then returns image itself, which keeps its cacheKey(), so statistics counted for it (see ImageStatistics) stay valid.
+	// Likewise the composite taken over from the previous workspace area (see takeCachesFrom()) if image is that composite,
+	// which is how a committed image with transparent pixels avoids a full render.
+	const bool fillsScene = image.size() == scaledImage.size() && image.size() == QSize(imageWidth, imageHeight) &&
+		sceneRect() == QRectF(0, 0, imageWidth, imageHeight) && items().size() == 1;
+	dirtyRegion = QRegion();
+	if (fillsScene && compositeValid && !composite.isNull() && composite.cacheKey() == image.cacheKey())
+	{
+		composite = image;
+	}
+	else if (fillsScene && PixelHelper::isOpaque(image))
+	{
+		compositePremultiplied = QImage();
+		composite = image;
+		compositeValid = true;
+	}
+	else
+	{
+		compositeValid = false;
+		compositePremultiplied = QImage();
+		composite = QImage();
+	}
 	emit imageLoaded(image);
 
 	modified = false;
 	update();
 }
 
+/**
+ * @brief Takes over what previous computed for its image, to be reused if the same image is opened here.
+ * @details Called before openImage(), which drops everything that belongs to another image.
+ *
+ * @param previous Workspace area this one replaces.
+ */
+void WorkspaceArea::takeCachesFrom(WorkspaceArea &previous)
+{
+	magicWand.takeComponentIndex(previous.magicWand);
+	// The flattened scene, still valid if openImage() is given the image the previous scene was committed to
+	composite = previous.composite;
+	compositePremultiplied = previous.compositePremultiplied;
+	compositeValid = previous.compositeValid;
+	previous.composite = QImage();
+	previous.compositePremultiplied = QImage();
+	previous.compositeValid = false;
+	magicWand.setSuperpixelIndex(previous.magicWand.getSuperpixelIndex());
+	previous.magicWand.setSuperpixelIndex(QSharedPointer<const SuperpixelIndex>());
+	// A superpixel build in progress finishes for this workspace area
+	if (previous.superpixelWatcher != nullptr)
+	{
+		superpixelWatcher = previous.superpixelWatcher;
+		superpixelKey = previous.superpixelKey;
+		previous.superpixelWatcher = nullptr;
+		superpixelWatcher->disconnect(&previous);
+		superpixelWatcher->setParent(this);
+		watchSuperpixelBuild();
+	}
+}
+
 /**
  * @brief Makes the brush strokes/drawing permanent, i.e. fused into the image.
+ * @details The flattened scene is cached. Only the area marked dirty since the last call is rendered again (see markDirty()),
+ * and committing an unchanged scene renders nothing. The cached image is usually shared with image,
+ * so updating it after a stroke still copies the whole image once, but no longer renders or converts all of it.
  * @return QImage Fused image (fused with brush strokes).
  */
 QImage WorkspaceArea::commitImage()
 {
-	if (isImageLoaded)
+	const QRect bounds(0, 0, imageWidth, imageHeight);
+	if (isImageLoaded && sceneRect() == QRectF(bounds))
+	{
+		if (!compositeValid || composite.size() != bounds.size())
+		{
+			compositePremultiplied = QImage(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+			composite = QImage();
+			dirtyRegion = bounds;
+			compositeValid = true;
+		}
+		dirtyRegion &= bounds;
+		if (dirtyRegion.isEmpty())
+		{
+			return composite;
+		}
+		if (dirtyRegion.rectCount() > MAX_DIRTY_RECTS)
+		{
+			dirtyRegion = dirtyRegion.boundingRect();
+		}
+		if (compositePremultiplied.isNull())
+		{
+			// Seeded from an opaque image in openImage(), premultiplying is exact
+			compositePremultiplied = composite.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+		}
+
+		// Scene and image coordinates coincide, so every dirty rectangle renders one to one
+		QPainter painter(&compositePremultiplied);
+		for (const QRect &rect : dirtyRegion)
+		{
+			// Replace the clip of the previous rectangle before clearing, or nothing would be cleared
+			painter.setClipRect(rect);
+			painter.setCompositionMode(QPainter::CompositionMode_Source);
+			painter.fillRect(rect, Qt::transparent);
+			painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+			render(&painter, rect, rect);
+		}
+		painter.end();
+
+		// Rendering is fastest premultiplied, filters expect straight alpha
+		if (composite.isNull())
+		{
+			composite = PixelHelper::toWorkingFormat(compositePremultiplied);
+		}
+		else
+		{
+			for (const QRect &rect : dirtyRegion)
+			{
+				for (int j = rect.top(); j <= rect.bottom(); ++j)
+				{
+					const QRgb *source = reinterpret_cast<const QRgb *>(compositePremultiplied.constScanLine(j));
+					QRgb *line = reinterpret_cast<QRgb *>(composite.scanLine(j));
+					for (int i = rect.left(); i <= rect.right(); ++i)
+					{
+						line[i] = qUnpremultiply(source[i]);
+					}
+				}
+			}
+		}
+		dirtyRegion = QRegion();
+		return composite;
+	}
+	else if (isImageLoaded)
 	{
 		QImage commitImage(imageWidth, imageHeight, QImage::Format_ARGB32_Premultiplied);
 		QPainter painter;
 		painter.begin(&commitImage);
 		render(&painter); // Renders the Workspace area to the image
 		painter.end();
-		return commitImage;
+		return PixelHelper::toWorkingFormat(commitImage); // Rendering is fastest premultiplied, filters expect straight alpha
 	}
 	else
 	{
@@ -124,6 +260,21 @@ QImage WorkspaceArea::commitImage()
     }
 }
 
+/**
+ * @brief Marks a scene area as changed, commitImage() renders it again.
+ * @details Every change to the scene that shows up in a committed image has to be marked.
+ *
+ * @param rect Changed area in scene coordinates.
+ */
+void WorkspaceArea::markDirty(const QRectF &rect)
+{
+	if (compositeValid)
+	{
+		// Antialiased edges may touch one more pixel
+		dirtyRegion += rect.toAlignedRect().adjusted(-1, -1, 1, 1);
+	}
+}
+
 /**
  * @brief Sets the workspaceImage to a committed version of it.
  */
@@ -183,6 +334,12 @@ void WorkspaceArea::mousePressEvent(QGraphicsSceneMouseEvent *event)
 	{
 		cropOriginScreen = event->screenPos();
 		cropOrigin = event->scenePos().toPoint();
+		if (magicWandMode == MagicWand::SelectionMode::CONTIGUOUS)
+		{
+			commitImageAndSet();
+			magicWand.beginSelection(image, cropOrigin.x(), cropOrigin.y());
+			scrubMagicWandThreshold(magicWandThreshold);
+		}
 	}
 	QGraphicsScene::mousePressEvent(event);
 }
@@ -227,36 +384,65 @@ void WorkspaceArea::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 		rubberBand->setGeometry(rect);
 		break;
 	}
+	case CursorMode::MAGICWAND:
+	{
+		// Dragging right raises, dragging left lowers the threshold, two screen pixels per step.
+		// Jitter of a plain click stays within the dead zone and keeps the threshold.
+		if (magicWandOverlay != nullptr)
+		{
+			const int drag = event->screenPos().x() - cropOriginScreen.x();
+			const int steps = qMax(0, qAbs(drag) - MAGIC_WAND_DEAD_ZONE) / 2;
+			scrubMagicWandThreshold(magicWandThreshold + (drag < 0 ? -steps : steps));
+		}
+		break;
+	}
 	}
 	QGraphicsScene::mouseMoveEvent(event);
 	modified = true;
 }
 
 /**
- * @brief Scribble action, draws painter path to path item.
+ * @brief Scribble action, appends a segment to the stroke item.
+ * @details Appending costs the same for every point of a stroke (see StrokeItem).
+ * The view repaints only the new segments, at most once per display refresh, however often the mouse reports moves.
  * 
  * @param pos Position to move
  * @param penColor 
  * @param penWidth 
  */
 void WorkspaceArea::onMoveScribble(QPointF pos, QColor penColor, int penWidth) {
-    QPainterPath path;
-    if (pathItem == nullptr)
+    if (strokeItem == nullptr)
     {
-        path.moveTo(pos); // move path to event scene position
-        pathItem = new QGraphicsPathItem();
         pen.setColor(penColor);
         pen.setBrush(penColor);
         pen.setWidth(penWidth);
-        pathItem->setPen(pen);   // set sticker pen to default pen
-        pathItem->setPath(path); // set sticker path to the new path
-        this->addItem(pathItem);
+        strokeItem = new StrokeItem(pen, pos); // start the stroke at event scene position
+        this->addItem(strokeItem);
+        const QScreen *screen = QGuiApplication::primaryScreen();
+        const qreal refreshRate = screen ? screen->refreshRate() : 60;
+        strokeUpdateTimer.setInterval(qMax(1, qRound(1000 / qMax<qreal>(1, refreshRate))));
+    }
+
+    const QRectF segment = strokeItem->append(pos); // draw line from last event pos to current pos
+    markDirty(segment);
+    pendingStrokeUpdate = pendingStrokeUpdate.united(segment);
+    if (!strokeUpdateTimer.isActive())
+    {
+        strokeUpdateTimer.start();
     }
+}
 
-    path = pathItem->path();		// get path from sticker
-    path.lineTo(pos); // draw line from last event pos to current pos
-    pathItem->setPath(path);
-    pathItem->update();
+/**
+ * @brief Repaints the stroke segments appended since the last repaint.
+ */
+void WorkspaceArea::flushStrokeUpdate()
+{
+    strokeUpdateTimer.stop();
+    if (strokeItem != nullptr && !pendingStrokeUpdate.isNull())
+    {
+        strokeItem->update(pendingStrokeUpdate);
+    }
+    pendingStrokeUpdate = QRectF();
 }
 
 /**
@@ -290,18 +476,26 @@ void WorkspaceArea::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 		break;
 	}
 	case CursorMode::MAGICWAND:
-        cropImageWithMagicWand(cropOrigin.x(), cropOrigin.y());
+	{
+		// The scrubbed threshold applies to this crop only, the controls keep their threshold
+		const int threshold = magicWandScrubThreshold >= 0 ? magicWandScrubThreshold : magicWandThreshold;
+		removeMagicWandOverlay();
+		cropImageWithMagicWand(cropOrigin.x(), cropOrigin.y(), threshold, magicWandMode);
 		break;
 	}
+	}
 	QGraphicsScene::mouseReleaseEvent(event);
 }
 /**
  * @brief When user release mouse press (cursor == SCRIBBLE), emits signal to update image preview and image drawn.
  */
 void WorkspaceArea::onReleaseScribble() {
+    flushStrokeUpdate();
+    // Antialiased stroke edges may touch one more pixel
+    QRect region = strokeItem ? strokeItem->mapRectToScene(strokeItem->strokeRect()).toAlignedRect().adjusted(-1, -1, 1, 1) : QRect();
     emit updateImagePreview();
-    emit imageDrawn();
-    pathItem = nullptr;
+    emit imageDrawn(region);
+    strokeItem = nullptr;
 }
 
 /**
@@ -355,27 +549,127 @@ void WorkspaceArea::resizeImage(int width, int height, bool fromServer)
 }
 
 /**
- * @brief Magic Wand cropping uses a filter from class MagicWand, with specified threshold (from data member)
+ * @brief Magic Wand cropping uses a filter from class MagicWand, with specified threshold and selection mode (from data members)
  * 
  * @param x x starting position.
  * @param y y starting position.
  * @param fromServer 
  */
 void WorkspaceArea::cropImageWithMagicWand(int x, int y, bool fromServer) {
+    cropImageWithMagicWand(x, y, magicWandThreshold, magicWandMode, fromServer);
+}
+
+/**
+ * @brief Magic Wand cropping with a given threshold and selection mode, e.g. those of a peer. The data members are left unchanged.
+ * 
+ * @param x x starting position.
+ * @param y y starting position.
+ * @param threshold Magic wand tolerance.
+ * @param mode Magic wand selection mode.
+ * @param fromServer 
+ */
+void WorkspaceArea::cropImageWithMagicWand(int x, int y, int threshold, MagicWand::SelectionMode mode, bool fromServer) {
     thisColor = PixelHelper::getPixel(image, x, y);
-    MagicWand m;
     commitImageAndSet();
-    QImage &&newImage = m.crop(image, x, y, magicWandThreshold);
+    QImage &&newImage = magicWand.crop(image, x, y, threshold, mode);
     emit imageCropped(newImage, newImage.width(), newImage.height());
     emit commitChanges("Magic Removal");
     if (!fromServer) {
-        emit sendCropWithMagicWand(x, y);
+        emit sendCropWithMagicWand(x, y, threshold, static_cast<int>(mode));
+    }
+}
+
+/**
+ * @brief Updates the magic wand selection preview to a new threshold while the mouse is dragged.
+ * @details The selection grows from or shrinks to the previous one (see MagicWand::updateSelection()),
+ * and only the pixels that joined or left it are redrawn and marked dirty, so the preview follows the mouse even on large images.
+ *
+ * @param threshold Threshold to preview, clamped to 0..255.
+ */
+void WorkspaceArea::scrubMagicWandThreshold(int threshold)
+{
+    threshold = qBound(0, threshold, 255);
+    if (threshold == magicWandScrubThreshold && magicWandOverlay != nullptr) {
+        return;
+    }
+    magicWandScrubThreshold = threshold;
+    const BitMask& selection = magicWand.updateSelection(threshold);
+    if (magicWandOverlay == nullptr) {
+        magicWandOverlay = new SelectionOverlayItem(QSize(selection.width(), selection.height()), qRgba(0, 120, 215, 128));
+        magicWandOverlay->setZValue(1);
+        addItem(magicWandOverlay);
+    }
+    const QRect changed = magicWandOverlay->updatePixels(selection, magicWand.selectionChanges());
+    if (!changed.isEmpty()) {
+        markDirty(magicWandOverlay->mapRectToScene(QRectF(changed)));
     }
 }
 
+/**
+ * @brief Removes the selection preview, it must not be rendered into a committed image.
+ */
+void WorkspaceArea::removeMagicWandOverlay()
+{
+    if (magicWandOverlay != nullptr) {
+        markDirty(magicWandOverlay->sceneBoundingRect());
+        removeItem(magicWandOverlay);
+        delete magicWandOverlay;
+        magicWandOverlay = nullptr;
+    }
+    magicWandScrubThreshold = -1;
+}
+
+/**
+ * @brief Segments the current image into superpixels in the background, see SuperpixelIndex.
+ * @details When the build finishes, magic wand clicks on this image select whole segments at once.
+ * Until then, or once the image changed, the magic wand selects pixel by pixel as before.
+ * Nothing is done if the current image is already segmented or being segmented, a build for an older image is superseded.
+ */
+void WorkspaceArea::buildSuperpixelIndex()
+{
+    if (image.isNull()) {
+        return;
+    }
+    const QSharedPointer<const SuperpixelIndex> index = magicWand.getSuperpixelIndex();
+    if ((index && index->isBuiltFrom(image)) || (superpixelWatcher != nullptr && superpixelKey == image.cacheKey())) {
+        return;
+    }
+    superpixelKey = image.cacheKey();
+    if (superpixelWatcher == nullptr) {
+        superpixelWatcher = new QFutureWatcher<SuperpixelIndex>(this);
+        watchSuperpixelBuild();
+    }
+    superpixelWatcher->setFuture(QtConcurrent::run(&SuperpixelIndex::build, image, static_cast<int>(SuperpixelIndex::SEGMENT_SIZE)));
+}
+
+/**
+ * @brief Hands the result of the superpixel build to the magic wand once it finishes.
+ */
+void WorkspaceArea::watchSuperpixelBuild()
+{
+    connect(superpixelWatcher, &QFutureWatcher<SuperpixelIndex>::finished, this, [this]() {
+        magicWand.setSuperpixelIndex(QSharedPointer<const SuperpixelIndex>(new SuperpixelIndex(superpixelWatcher->result())));
+    });
+}
+
+/**
+ * @brief Drops the superpixel index, a build in progress is ignored.
+ */
+void WorkspaceArea::clearSuperpixelIndex()
+{
+    if (superpixelWatcher != nullptr) {
+        superpixelWatcher->disconnect(this);
+        superpixelWatcher->deleteLater();
+        superpixelWatcher = nullptr;
+    }
+    superpixelKey = 0;
+    magicWand.setSuperpixelIndex(QSharedPointer<const SuperpixelIndex>());
+}
+
 /**
  * @brief Commits the image. Passed to color controls' image previewer.
- * @details check commitImage() for how this works.
+ * @details Only the previewed rectangle is rendered, or copied from the composite cached by commitImage()
+ * if none of it changed since. So a preview costs about its own size, whatever the size of the image.
  * 
  * @return QImage Comitted image.
  */
@@ -395,18 +689,23 @@ QImage WorkspaceArea::commitImageForPreview()
 			x = y = 0;
 		}
 		QRect previewRect = QRect(x, y, width, height);
-		// We get a committed image ready.
-		QImage commitImage(imageWidth, imageHeight, QImage::Format_ARGB32_Premultiplied);
+		if (compositeValid && !composite.isNull() && !dirtyRegion.intersects(previewRect))
+		{
+			return composite.copy(previewRect).scaled(200, 200, Qt::KeepAspectRatio);
+		}
+		// Render the preview rect only, one to one, as commitImage() would
+		QImage commitImage(previewRect.size(), QImage::Format_ARGB32_Premultiplied);
+		commitImage.fill(Qt::transparent);
 		QPainter painter;
 		painter.begin(&commitImage);
-		render(&painter); // Renders the Workspace area to the image
+		render(&painter, QRectF(commitImage.rect()), QRectF(previewRect));
 		painter.end();
-		return commitImage.copy(previewRect).scaled(200, 200, Qt::KeepAspectRatio);
+		return PixelHelper::toWorkingFormat(commitImage.scaled(200, 200, Qt::KeepAspectRatio));
 	}
 	else
 	{
 		// Return a 200x200 white image if there is no image loaded in the workspace area.
-		QImage commitImage(200, 200, QImage::Format_ARGB32_Premultiplied);
+		QImage commitImage(200, 200, PixelHelper::WORKING_FORMAT);
 		commitImage.fill(Qt::white);
 		return commitImage;
 	}
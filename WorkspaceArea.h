@@ -7,6 +7,14 @@
 #include <QPoint>
 #include <QGraphicsScene>
 #include <QRubberBand>
+#include <QRegion>
+#include <QFutureWatcher>
+#include <QTimer>
+
+#include "FilterTransform/NonKernelBased/MagicWand.h"
+#include "Utilities/SuperpixelIndex.h"
+#include "Utilities/SelectionOverlayItem.h"
+#include "Utilities/StrokeItem.h"
 
 namespace Ui {
 class WorkspaceArea;
@@ -35,6 +43,7 @@ public:
 
 public:
     void                        openImage(const QImage&, int width, int height);
+    void                        takeCachesFrom(WorkspaceArea& previous);
     bool                        saveImage(const QString& fileName, const char* fileFormat);
     int                         getImageWidth() const { return imageWidth; }                    //!< Get image width.
     int                         getImageHeight() const { return imageHeight; }                  //!< Get image height.
@@ -48,14 +57,20 @@ public:
     void                        setPenColor(const QColor& newColor) { myPenColor = newColor; }                      //!< Sets pen color to newColor.
     void                        setPenWidth(int newWidth) { myPenWidth = newWidth; }                                //!< Sets pen width to newWidth.
     void                        setModified(bool modified) { this->modified = modified; }                           //!< Sets if workspace area is modified.
-    void                        setImageLoaded(bool isImageLoaded) { this->isImageLoaded = isImageLoaded ; }        //!< Sets if workspace area is loaded with image.
+    void                        setImageLoaded(bool isImageLoaded) { this->isImageLoaded = isImageLoaded; compositeValid = false; }  //!< Sets if workspace area is loaded with image.
     void                        setCursorMode(CursorMode cursorMode) { this->cursorMode = cursorMode; }             //!< Sets cursor mode of workspace area.
     void                        setMagicWandThreshold(int threshold) { this->magicWandThreshold = threshold; }      //!< Sets magic wand threshold.
+    void                        setMagicWandMode(MagicWand::SelectionMode mode) { this->magicWandMode = mode; }     //!< Sets magic wand selection mode.
     QImage                      commitImage();
     void                        commitImageAndSet();
     QImage                      commitImageForPreview();
     void                        cropImage(int, int, int, int, bool = false);
     void                        cropImageWithMagicWand(int, int, bool = false);
+    void                        cropImageWithMagicWand(int, int, int threshold, MagicWand::SelectionMode mode, bool = false);
+    void                        scrubMagicWandThreshold(int threshold);
+    void                        removeMagicWandOverlay();
+    void                        buildSuperpixelIndex();
+    void                        clearSuperpixelIndex();
     void                        onMoveScribble(QPointF, QColor, int);
     void                        onReleaseScribble();
 
@@ -67,17 +82,19 @@ public slots:
 public:
     static const int SCENE_WIDTH = 720;    //!< The default width of the workspace
     static const int SCENE_HEIGHT = 480;   //!< The default height of the workspace
+    static const int MAX_DIRTY_RECTS = 32; //!< More dirty rectangles than this are rendered as their bounding rectangle.
+    static const int MAGIC_WAND_DEAD_ZONE = 4; //!< Screen pixels a magic wand click may move before dragging changes the threshold.
 
 signals:
     void                        imageLoaded(const QImage& image);                       //!< Signals the mainwindow to update the histogram on image load.
-    void                        imageDrawn();                                           //!< Signals the mainwindow, go to slot &MainWindow::onImageDrawn.
+    void                        imageDrawn(const QRect& region);                        //!< Signals the mainwindow, go to slot &MainWindow::onImageDrawn. region covers the stroke.
     void                        imageCropped(const QImage&, int width, int height);     //!< Signals the mainwindow to rerender workspaceArea with these arguments
     void                        imageResized(const QImage&, int width, int height);     //!< Signals the mainwindow to rerender workspaceArea with these arguments
     void                        commitChanges(QString changes);                         //!< Signals the mainwindow, go to slot &Mainwindow::onCommitChanges
     void                        updateImagePreview();                                   //!< Signals the mainwindow, go to slot &Mainwindow::onUpdateImagePreview
     void                        sendResize(int, int);
     void                        sendCrop(int, int, int, int);
-    void                        sendCropWithMagicWand(int, int);
+    void                        sendCropWithMagicWand(int, int, int, int);
     void                        sendMoveScribble(double, double, QString, int);
     void                        sendReleaseScribble();
 
@@ -86,6 +103,11 @@ protected:
     virtual void                mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
     virtual void                mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
 
+private:
+    void                        markDirty(const QRectF& rect);
+    void                        flushStrokeUpdate();
+    void                        watchSuperpixelBuild();
+
 private:
     bool                        modified;                           //!< Workspace was modified
     bool                        isImageLoaded = false;              //!< If true, loaded image can be drawn without new canvas
@@ -101,7 +123,13 @@ private:
     int                         imageWidth;                         //!< Saves the width of our current image
     int                         imageHeight;                        //!< Saves the height of our current image
     QGraphicsPixmapItem*        pixmapGraphics = nullptr;           //!< The pointer to foreground image item
-    QGraphicsPathItem*          pathItem = nullptr;                 //!< Pointer to the strokes created when drawing
+    StrokeItem*                 strokeItem = nullptr;               //!< Pointer to the stroke created when drawing
+    QRectF                      pendingStrokeUpdate;                //!< Stroke segments not yet repainted in the view.
+    QTimer                      strokeUpdateTimer;                  //!< Repaints pendingStrokeUpdate at most once per display refresh.
+    QImage                      compositePremultiplied;             //!< Last rendering of the scene, premultiplied as the painter needs it.
+    QImage                      composite;                          //!< compositePremultiplied in the working format, returned by commitImage().
+    QRegion                     dirtyRegion;                        //!< Scene area changed since the composite was rendered.
+    bool                        compositeValid = false;             //!< False if the composite has to be rendered from scratch.
 
     QPoint                      cropOriginScreen;                   //!< Point to start cropping, relative to screen
     QPoint                      cropOrigin;                         //!< Point to start cropping, relative to scene
@@ -111,6 +139,12 @@ private:
     double                      dy;                                 //!< y difference between screen position and scene position
     QRgb                        thisColor;                          //!< Magic wand color to remove
     int                         magicWandThreshold = 5;             //!< Threshold for magic wand tolerence.
+    MagicWand::SelectionMode    magicWandMode = MagicWand::SelectionMode::CONTIGUOUS;  //!< Which pixels a magic wand click selects.
+    MagicWand                   magicWand;                          //!< Magic wand, keeps the incremental selection while the threshold is scrubbed.
+    int                         magicWandScrubThreshold = -1;       //!< Threshold chosen by dragging, -1 if not scrubbing.
+    SelectionOverlayItem*       magicWandOverlay = nullptr;         //!< Preview of the selection while scrubbing.
+    QFutureWatcher<SuperpixelIndex>* superpixelWatcher = nullptr;   //!< Background build of the superpixel index of image.
+    qint64                      superpixelKey = 0;                  //!< QImage::cacheKey() of the image the running or finished superpixel build segments.
 };
 
 #endif // WORKSPACEAREA_H